@@ -0,0 +1,69 @@
+/* Licensed under GNU General Public License v3.0
+  See https://github.com/jeffasuk/thermostat
+  jeff at jamcupboard.co.uk
+*/
+#include "globals.h"
+#include "compression.h"
+
+/* Swinging-door compression of the reported temperature.
+   Starting from the last reported (archived) point, two "doors" pivot at archived value +/- deviation.
+   Each new point narrows them: the upper door's slope can only come down and the lower door's only go up.
+   While the doors are still open, every point seen since the archived one lies within deviation of a straight
+   line from the archived point, so the server can reconstruct them by interpolation and nothing needs sending.
+   Once they cross, the previous point becomes the new archived point and must be reported.
+   Times are millis(); slopes are degrees per second.
+*/
+static uint32_t archived_t;
+static float    archived_value;
+static uint32_t previous_t;
+static float    previous_value;
+static uint8_t  have_archive = 0;
+static uint8_t  have_previous = 0;
+static float    slope_upper;    // lowest slope so far of the line to (value + deviation)
+static float    slope_lower;    // highest slope so far of the line to (value - deviation)
+
+// A point has been reported, by whatever means
+void archiveCompressionPoint(uint32_t t, float value)
+{
+    archived_t = t;
+    archived_value = value;
+    have_archive = 1;
+    have_previous = 0;
+}
+
+static void narrowDoors(uint32_t t, float value, float deviation, uint8_t first)
+{
+    float dt = (t - archived_t) / 1000.0;
+    float upper = (value + deviation - archived_value) / dt;
+    float lower = (value - deviation - archived_value) / dt;
+    slope_upper = first ? upper : min(slope_upper, upper);
+    slope_lower = first ? lower : max(slope_lower, lower);
+    previous_t = t;
+    previous_value = value;
+    have_previous = 1;
+}
+
+// Returns 1 if the previous point has to be reported, in which case it becomes the archived point.
+uint8_t swingingDoorCheck(uint32_t t, float value, float deviation)
+{
+    if (!have_archive)
+    {
+        archiveCompressionPoint(t, value);
+        return 0;
+    }
+    if (t == archived_t)
+    {
+        return 0;
+    }
+    narrowDoors(t, value, deviation, !have_previous);
+    if (slope_lower <= slope_upper)
+    {
+        return 0;
+    }
+    // Doors have crossed. Restart from the previous point, with just the current point inside the doors.
+    // (have_previous must have been set already, as a single point can't cross the doors.)
+    archiveCompressionPoint(previous_t, previous_value);
+    have_previous = 0;
+    narrowDoors(t, value, deviation, 1);
+    return 1;
+}
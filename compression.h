@@ -0,0 +1,12 @@
+/* Licensed under GNU General Public License v3.0
+  See https://github.com/jeffasuk/thermostat
+  jeff at jamcupboard.co.uk
+*/
+
+#ifndef _COMPRESSION_H
+#define _COMPRESSION_H
+
+void archiveCompressionPoint(uint32_t t, float value);
+uint8_t swingingDoorCheck(uint32_t t, float value, float deviation);
+
+#endif  // _COMPRESSION_H
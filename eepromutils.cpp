@@ -5,6 +5,8 @@
 #include <Arduino.h>
 #include <EEPROM.h>
 #include "globals.h"
+#include "eepromutils.h"
+#include "utils.h"
 
 /* The following macro caters for all the various int types in persistent data.
     Although using a macro doesn't reduce code size, it does make modifications/bug fixes easier.
@@ -16,146 +18,196 @@
     DOPRINTLN(*((VAR_TYPE*)(p_settable->value))); \
 }
 
-uint8_t eepromIsUninitialized()
+#define EEPROM_SIZE         512
+#define RECORD_HAS_CRC      'c'     // last byte of the tag in a record that ends with a CRC
+#define MAX_STRING_LEN      200
+
+/* Settings are saved in the journal now (settingsjournal.cpp). EEPROM is only read, once, to bring over
+   the settings of a unit that saved them there before.
+   The record in EEPROM is:
+     magic_tag, with its terminating 0 replaced by RECORD_HAS_CRC
+     the first EEPROM_DATA_SIZE bytes of persistent_data, byte for byte
+     each persistent string as a 16-bit length and then its bytes, no terminator
+     CRC32 of everything above
+   All multi-byte values are least significant byte first.
+   A record written before the CRC was added has 0 as the last byte of the tag and no CRC. It's accepted
+   as it stands.
+*/
+
+/* Every layout the record has had, by the last character of the tag. Each version added fields to the
+   end of PERSISTENT_DATA (and v33 added mqtthost to the end of the strings), so an older record is read
+   by taking just the fields it had. The others keep their defaults.
+   data_size is sizeof persistent_data as it was then, which includes padding up to a multiple of 4.
+*/
+#define PADDED(n)   (((n) + 3) & ~3)
+struct EEPROM_LAYOUT {
+    char    version;
+    uint8_t fields_size;
+    uint8_t data_size;
+    uint8_t nb_strings;
+};
+static const struct EEPROM_LAYOUT eeprom_layouts[] = {
+    {'0', offsetof(struct PERSISTENT_DATA, telemetry_format),  PADDED(offsetof(struct PERSISTENT_DATA, telemetry_format)), 7},
+    {'1', offsetof(struct PERSISTENT_DATA, udp_port),          PADDED(offsetof(struct PERSISTENT_DATA, udp_port)), 7},
+    {'2', offsetof(struct PERSISTENT_DATA, mqtt_port),         PADDED(offsetof(struct PERSISTENT_DATA, mqtt_port)), 7},
+    {'3', offsetof(struct PERSISTENT_DATA, compression_dev),   PADDED(offsetof(struct PERSISTENT_DATA, compression_dev)), 8},
+    {'4', offsetof(struct PERSISTENT_DATA, cfg_poll_sec),      PADDED(offsetof(struct PERSISTENT_DATA, cfg_poll_sec)), 8},
+    {'5', EEPROM_DATA_SIZE,                                    EEPROM_DATA_SIZE, 8},
+};
+#define NB_LAYOUTS      (sizeof eeprom_layouts / sizeof eeprom_layouts[0])
+#define CURRENT_LAYOUT  (&eeprom_layouts[NB_LAYOUTS - 1])    // the one magic_tag names
+
+static const struct EEPROM_LAYOUT *layout = CURRENT_LAYOUT;   // of the record in EEPROM
+
+static uint16_t readUint16(int c)
 {
-    char in;
+    return (EEPROM.read(c) & 0xff) | ((EEPROM.read(c + 1) << 8) & 0xff00);
+}
+
+static uint32_t readUint32(int c)
+{
+    return readUint16(c) | ((uint32_t)readUint16(c + 2) << 16);
+}
+
+/* Offset just past the last string of the record in the open EEPROM, or 0 if the lengths don't add up.
+*/
+static int recordEnd()
+{
+    int c = sizeof magic_tag + layout->data_size;
+    PERSISTENT_STRING_INFO *pers_str_ptr;
     int i;
-    int ret = 0;
-    EEPROM.begin(512);
-    DOPRINTLN("Checking magic tag");
-    for (i=0; i < sizeof magic_tag; ++i)
+    for (pers_str_ptr = persistent_strings, i=0; pers_str_ptr->name && i < layout->nb_strings; ++pers_str_ptr, ++i)
     {
-        in = EEPROM.read(i);
-        if (in != magic_tag[i])
+        uint16_t string_len;
+        if (c + 2 > EEPROM_SIZE)
         {
-            DOPRINT("Found difference on byte ");
-            DOPRINTLN(i);
-            ret = i+1;
-            break;
+            return 0;
+        }
+        string_len = readUint16(c);
+        c += 2 + string_len;
+        if (string_len > MAX_STRING_LEN || c > EEPROM_SIZE)
+        {
+            DOPRINT(F("Bad length for "));
+            DOPRINT(FPSTR(pers_str_ptr->name));
+            DOPRINT(F(": "));
+            DOPRINTLN(string_len);
+            return 0;
         }
     }
-    EEPROM.end();
-    return ret;
+    return c;
 }
 
-static void writeMagicTag()
+/* Checks the tag, the string lengths and the CRC. Returns non-zero if the record can't be used.
+   Records in any of the earlier layouts are accepted.
+*/
+uint8_t eepromIsUninitialized()
 {
-    char in;
-    int i;
-    EEPROM.begin(512);
-    DOPRINTLN("Writing magic tag");
-    for (i=0; i < sizeof magic_tag; ++i)
+    int i, end;
+    uint32_t crc;
+    uint8_t ret = 0;
+    EEPROM.begin(EEPROM_SIZE);
+    DOPRINTLN(F("Checking magic tag"));
+    for (i=0; i < sizeof magic_tag - 2; ++i)
+    {
+        if (EEPROM.read(i) != magic_tag[i])
+        {
+            DOPRINT(F("Found difference on byte "));
+            DOPRINTLN(i);
+            ret = i+1;
+            break;
+        }
+    }
+    if (!ret)
     {
-        DOPRINTLN(magic_tag[i]);
-        EEPROM.write(i, magic_tag[i]);
+        char version = EEPROM.read(sizeof magic_tag - 2);
+        for (layout = eeprom_layouts; layout < eeprom_layouts + NB_LAYOUTS && layout->version != version; ++layout)
+        {
+        }
+        if (layout == eeprom_layouts + NB_LAYOUTS)
+        {
+            DOPRINT(F("Unknown layout "));
+            DOPRINTLN(version);
+            layout = CURRENT_LAYOUT;
+            ret = sizeof magic_tag - 1;
+        }
+    }
+    if (!ret)
+    {
+        uint8_t format = EEPROM.read(sizeof magic_tag - 1);
+        end = recordEnd();
+        if (!end)
+        {
+            ret = sizeof magic_tag;
+        }
+        else if (format == 0)
+        {
+            DOPRINTLN(F("Record has no CRC"));
+        }
+        else if (format != RECORD_HAS_CRC || end + 4 > EEPROM_SIZE)
+        {
+            DOPRINTLN(F("Unknown record format"));
+            ret = sizeof magic_tag;
+        }
+        else
+        {
+            for (crc = 0, i=0; i < end; ++i)
+            {
+                uint8_t b = EEPROM.read(i);
+                crc = crc32Append(crc, &b, 1);
+            }
+            if (crc != readUint32(end))
+            {
+                DOPRINTLN(F("CRC mismatch"));
+                ret = sizeof magic_tag + 1;
+            }
+        }
     }
     EEPROM.end();
-    DOPRINTLN("Done writing magic tag");
-    //delay(500);   The ESP with relay does not like a delay, but doesn't seem to need it anyway, or maybe 'cos I'm threading
+    return ret;
 }
 
-static void readWriteEeprom(int dowrite)
+/* Only to be called after eepromIsUninitialized() has passed the record.
+   Fields that weren't in the record's layout are left as they are.
+*/
+void readFromEeprom()
 {
     uint8_t *p;
-    int c, l;
+    int c, l, i;
     PERSISTENT_STRING_INFO *pers_str_ptr;
 
-    DOPRINTLN("Start read/write EEPROM");
-    DOPRINTLN(dowrite);
-    l = sizeof persistent_data;
-    EEPROM.begin(512);
-    for (p = (uint8_t*)&persistent_data, l = sizeof persistent_data, c=sizeof magic_tag; l; c++, l--)
+    EEPROM.begin(EEPROM_SIZE);
+    for (p = (uint8_t*)&persistent_data, l = layout->fields_size, c=sizeof magic_tag; l; c++, l--)
     {
-        if (dowrite)
-        {
-            char buf[10];
-            DOPRINT("EEP write ");
-            DOPRINT(c);
-            DOPRINT(" ");
-            sprintf(buf, " %x", *p & 0xff);
-            DOPRINT(buf);
-            DOPRINTLN("");
-            EEPROM.write(c, *p++);
-        }
-        else
-        {
-            *p++ = EEPROM.read(c);
-        }
+        *p++ = EEPROM.read(c);
     }
+    c = sizeof magic_tag + layout->data_size;
     // That's the easy bit; the struct. Now for the variable-length strings.
     // In the EEPROM, use Pascal-style (length,value) strings for ease of memory allocation.
-    for (pers_str_ptr = persistent_strings; pers_str_ptr->name; ++pers_str_ptr)
+    for (pers_str_ptr = persistent_strings, i=0; pers_str_ptr->name && i < layout->nb_strings; ++pers_str_ptr, ++i)
     {
         uint16_t string_len;
         char    *p;
-        DOPRINT("EEP field ");
-        DOPRINTLN((char*)(pers_str_ptr->name));
-        if (dowrite)
+        string_len = readUint16(c);
+        c += 2;
+        if (*(pers_str_ptr->value))
         {
-            if (*(pers_str_ptr->value))
-            {
-                string_len = strlen(*(pers_str_ptr->value));
-                DOPRINTLN((char*)(pers_str_ptr->value));
-                EEPROM.write(c++, string_len & 0xff);
-                EEPROM.write(c++, (string_len >> 8) & 0xff);
-                for (p = *(pers_str_ptr->value); *p; ++p)
-                {
-                    EEPROM.write(c++, *p);
-                }
-            }
-            else
+            free(*(pers_str_ptr->value));
+        }
+        if (string_len)
+        {
+            p = *(pers_str_ptr->value) = (char*)malloc(string_len+1);
+            while (string_len--)
             {
-                // 16 bits of zero for item with no value
-                DOPRINTLN("  empty");
-                EEPROM.write(c++, 0);
-                EEPROM.write(c++, 0);
+                *p++ = EEPROM.read(c++);
             }
+            *p = '\0';
         }
         else
         {
-            string_len = (EEPROM.read(c++) & 0xff) + ((EEPROM.read(c++) << 8) & 0xff00);
-            if (string_len > 200)
-            {
-                DOPRINT("String too long: ");
-                DOPRINT(pers_str_ptr->name);
-                DOPRINT(", ");
-                DOPRINTLN(string_len);
-                break;
-            }
-            if (*(pers_str_ptr->value))
-            {
-                free(*(pers_str_ptr->value));
-            }
-            if (string_len)
-            {
-                p = *(pers_str_ptr->value) = (char*)malloc(string_len+1);
-                while (string_len--)
-                {
-                    *p++ = EEPROM.read(c++);
-                }
-                *p = '\0';
-            }
-            else
-            {
-                *(pers_str_ptr->value) = 0;
-            }
+            *(pers_str_ptr->value) = 0;
         }
     }
     EEPROM.end();
-    if (dowrite)
-    {
-        //delay(100);   The ESP with relay does not like a delay, but doesn't seem to need it anyway, or maybe 'cos I'm threading
-    }
-}
-void readFromEeprom()
-{
-    readWriteEeprom(0);
-}
-void writeToEeprom()
-{
-    writeMagicTag();
-    DOPRINTLN("Returned from writing magic tag");
-    readWriteEeprom(1);
 }
 
 void showSettings()
@@ -165,9 +217,9 @@ void showSettings()
     // simple values
     for (p_settable = persistents; p_settable->name; ++p_settable)
     {
-        DOPRINT("  ");
-        DOPRINT(p_settable->name);
-        DOPRINT("=");
+        DOPRINT(F("  "));
+        DOPRINT(FPSTR(p_settable->name));
+        DOPRINT(F("="));
         switch (p_settable->type)
         {
           case PERS_INT8:
@@ -201,19 +253,19 @@ void showSettings()
     // string values
     for (pers_str_ptr = persistent_strings; pers_str_ptr->name; ++pers_str_ptr)
     {
-        DOPRINT("  ");
-        DOPRINT(pers_str_ptr->name);
-        DOPRINT("=");
+        DOPRINT(F("  "));
+        DOPRINT(FPSTR(pers_str_ptr->name));
+        DOPRINT(F("="));
         if (*(pers_str_ptr->value))
         {
-            DOPRINT("'");
+            DOPRINT(F("'"));
             DOPRINT(*(pers_str_ptr->value));
-            DOPRINT("'");
+            DOPRINT(F("'"));
         }
         else
         {
-            DOPRINT("empty");
+            DOPRINT(F("empty"));
         }
-        DOPRINTLN("");
+        DOPRINTLN(F(""));
     }
 }
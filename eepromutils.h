@@ -4,5 +4,4 @@
 */
 extern uint8_t eepromIsUninitialized();
 extern void readFromEeprom();
-extern void writeToEeprom();
 void showSettings();
@@ -0,0 +1,67 @@
+/* Licensed under GNU General Public License v3.0
+  See https://github.com/jeffasuk/thermostat
+  jeff at jamcupboard.co.uk
+*/
+#include "globals.h"
+
+char magic_tag[4] = "v35";    // Layout of the settings record in EEPROM, which older firmware kept settings in.
+            // Settings are kept in the journal now (see settingsjournal.h), and the EEPROM is only read
+            // to bring them across, so this never needs changing. eepromutils.cpp reads all the layouts.
+
+
+float current_temperature = IMPOSSIBLE_TEMPERATURE;
+float switch_temperature = IMPOSSIBLE_TEMPERATURE;
+float switch_offset_above = 0;
+float switch_offset_below = 0;
+SENSOR_DATA sensor_data = {0};
+
+// 0 means "off", which matches the start-up hardware state
+int8_t main_state = 0;
+int8_t power_state = 0;
+
+uint8_t in_setup_mode = 0;
+
+char *new_etag = 0;
+
+BOOT_TIMES boot_times = {0};
+
+#define X(NAME, VAR, FIELD, FORM) char *VAR = 0;
+PERSISTENT_STRINGS(X)
+#undef X
+
+struct PERSISTENT_DATA persistent_data = {
+#define X(CTYPE, NAME, DEFAULT, FIELD, FORM) DEFAULT,
+    PERSISTENT_NUMBERS(X)
+#undef X
+};
+
+/* The names in the tables below are kept in flash rather than RAM, so each has to be a named array
+   (PSTR() can't be used in a static initializer). A field name array that's not used (NO_FORM) is
+   optimised away.
+*/
+#define X(CTYPE, NAME, DEFAULT, FIELD, FORM) \
+    static const char pn_##NAME[] PROGMEM = #NAME; \
+    static const char fn_##NAME[] PROGMEM = #FIELD;
+PERSISTENT_NUMBERS(X)
+#undef X
+#define X(NAME, VAR, FIELD, FORM) \
+    static const char pn_##NAME[] PROGMEM = #NAME; \
+    static const char fn_##NAME[] PROGMEM = #FIELD;
+PERSISTENT_STRINGS(X)
+#undef X
+
+PERSISTENT_INFO persistents[] = {
+#define X(CTYPE, NAME, DEFAULT, FIELD, FORM) \
+    {PERSISTENT_TYPE_OF<CTYPE>::type, pn_##NAME, &persistent_data.NAME, (FORM) ? fn_##NAME : 0, FORM},
+    PERSISTENT_NUMBERS(X)
+#undef X
+    {PERS_INT8, 0}
+};
+
+PERSISTENT_STRING_INFO persistent_strings[] = {
+#define X(NAME, VAR, FIELD, FORM) \
+    {pn_##NAME, &VAR, (FORM) ? fn_##NAME : 0, FORM},
+    PERSISTENT_STRINGS(X)
+#undef X
+    {0}
+};
@@ -34,6 +34,10 @@ extern char magic_tag[4];
 #define HEATING     0
 #define COOLING     1
 
+// report formats
+#define TELEMETRY_QUERY     0   // original URL query string
+#define TELEMETRY_BINARY    1   // compact binary, see telemetry.h
+
 // sensors
 #define MAX_TEMPERATURE_SENSORS 8
 
@@ -61,51 +65,123 @@ extern int8_t main_state;
 extern uint8_t in_setup_mode;
 extern char *new_etag;
 
-// settable
-extern char *p_etag;
-extern char *p_ssid;
-extern char *p_passrot;
-extern char *p_report_hostname;
-extern char *p_report_path;
-extern char *p_cfg_path;   // not currently used
-extern char *p_identifier;
-
-struct PERSISTENT_DATA {    // this structure can be stored in EEPROM
-    uint16_t port;
-    uint8_t onewire_pin;
-    int8_t  rot;
-    uint32_t max_time_between_reports;
-    uint32_t fan_overrun_sec;
-    float   desired_temperature;
-    float   precision;
-    uint8_t mode;
+/* When each stage of start-up was first reached, in ms since reset (millis()), or 0 if it hasn't been yet.
+   Shown in /status, to keep an eye on how long the heating is left uncontrolled after a power cut.
+*/
+typedef struct {
+    uint32_t    setup;          // setup() entered. Time taken by the boot ROM and SDK
+    uint32_t    settings;       // settings loaded
+    uint32_t    reading;        // first good reading from the controlling sensor
+    uint32_t    decision;       // relays first set from a reading, or off for want of one
+    uint32_t    wifi;           // WiFi connected
+} BOOT_TIMES;
+extern BOOT_TIMES boot_times;
+// Only the first time. | 1 so that a stage reached at 0 ms doesn't look unreached
+#define NOTE_BOOT_TIME(stage)   do { if (!boot_times.stage) boot_times.stage = millis() | 1; } while (0)
+
+/* Every setting that's kept across restarts, in one place. The storage and defaults (globals.cpp), the tables
+   below, the web form fields and the name lookups (persistence.cpp) are all generated from these two lists.
+
+   Numbers: X(C type, name, default, form field, form)
+   They're kept in struct PERSISTENT_DATA in this order. The old EEPROM layouts (see eepromutils.cpp) depend
+   on that, so add new ones at the end.
+   Strings: X(name, variable, form field, form)
+   Each is a pointer to a malloced copy, or NULL if it's not set.
+
+   The name is what the server sends, what the journal keeps, and what %%name%% stands for in the set-up page.
+   The form is the one with a field that sets the setting: SETUP_FORM (/setup), SETTINGS_FORM (/settings,
+   from the home page), or NO_FORM, in which case the field name isn't used.
+   The name lookup tables (persistence.cpp) have room for 63 settings in all. Past that, the build stops
+   and NAME_HASH_BITS needs raising.
+*/
+#define NO_FORM         0
+#define SETUP_FORM      1
+#define SETTINGS_FORM   2
+
+#define PERSISTENT_NUMBERS(X) \
+    X(uint16_t, port,                       0,                  port,               SETUP_FORM)     /* of the report server */ \
+    X(uint8_t,  onewire_pin,                13,                 _,                  NO_FORM)        \
+    X(int8_t,   rot,                        3,                  _,                  NO_FORM)        /* rotation for passwords */ \
+    X(uint32_t, max_time_between_reports,   20,                 maxreporttime,      SETTINGS_FORM)  /* seconds */ \
+    X(uint32_t, fan_overrun_sec,            0,                  fan_overrun_sec,    SETTINGS_FORM)  \
+    X(float,    desired_temperature,        20.0,               des_temp,           SETTINGS_FORM)  \
+    X(float,    precision,                  0.2,                precision,          SETTINGS_FORM)  /* for stability when looking at temperature changes, esp. for change of direction */ \
+    X(uint8_t,  mode,                       HEATING,            mode,               SETTINGS_FORM)  /* HEATING or COOLING */ \
+    X(uint8_t,  telemetry_format,           TELEMETRY_QUERY,    _,                  NO_FORM)        /* TELEMETRY_QUERY or TELEMETRY_BINARY */ \
+    X(uint16_t, udp_port,                   0,                  _,                  NO_FORM)        /* non-zero to send periodic reports as UDP datagrams to this port */ \
+    X(uint16_t, mqtt_port,                  1883,               _,                  NO_FORM)        /* of the MQTT broker, if mqtthost is set */ \
+    X(float,    compression_dev,            0,                  _,                  NO_FORM)        /* non-zero to skip periodic reports that the server can interpolate to within this many degrees */ \
+    X(uint32_t, cfg_poll_sec,               300,                _,                  NO_FORM)        /* how often to fetch settings from cfgpath. 0 = only at start-up */ \
+    /* Numbers after this point aren't in the EEPROM record. See EEPROM_DATA_SIZE. */ \
+    X(uint16_t, save_delay_sec,             10,                 _,                  NO_FORM)        /* save settings once they've been left alone this long */ \
+    X(uint16_t, save_max_wait_sec,          60,                 _,                  NO_FORM)        /* but no later than this after the first unsaved change */ \
+    X(uint8_t,  fast_boot,                  1,                  _,                  NO_FORM)        /* start controlling at once and bring WiFi up in the background. See setup(). Off for units set up before it existed */ \
+    X(uint8_t,  wifi_channel,               0,                  _,                  NO_FORM)        /* of the access point last connected to, with bssid. 0 = not known */
+
+#define PERSISTENT_STRINGS(X) \
+    X(etag,     p_etag,             _,      NO_FORM)        /* of the last settings fetched from cfgpath. Set from an HTTP header, not content */ \
+    X(ssid,     p_ssid,             ssid,   SETUP_FORM)     \
+    X(rotpass,  p_passrot,          pswd,   SETUP_FORM)     \
+    X(rpthost,  p_report_hostname,  host,   SETUP_FORM)     \
+    X(rptpath,  p_report_path,      rpath,  SETUP_FORM)     \
+    X(cfgpath,  p_cfg_path,         cpath,  SETUP_FORM)     /* settings are fetched from here, if set */ \
+    X(ident,    p_identifier,       ident,  SETUP_FORM)     \
+    X(mqtthost, p_mqtt_hostname,    _,      NO_FORM)        /* if set, report to this MQTT broker instead of over HTTP */ \
+    X(bssid,    p_bssid,            _,      NO_FORM)        /* aa:bb:cc:dd:ee:ff of the access point last connected to, so it can be joined without a scan */ \
+    X(ip,       p_static_ip,        _,      NO_FORM)        /* if set, with gateway and netmask, use this address instead of DHCP */ \
+    X(gateway,  p_gateway,          _,      NO_FORM)        \
+    X(netmask,  p_netmask,          _,      NO_FORM)        \
+    X(dns,      p_dns,              _,      NO_FORM)        /* defaults to the gateway */
+
+struct PERSISTENT_DATA {
+#define X(CTYPE, NAME, DEFAULT, FIELD, FORM) CTYPE NAME;
+    PERSISTENT_NUMBERS(X)
+#undef X
 };
+#define EEPROM_DATA_SIZE    offsetof(struct PERSISTENT_DATA, save_delay_sec)
 extern struct PERSISTENT_DATA persistent_data;
 
+#define X(NAME, VAR, FIELD, FORM) extern char *VAR;
+PERSISTENT_STRINGS(X)
+#undef X
+
+#define COUNT_SETTING(...) + 1
+#define NB_PERSISTENT_NUMBERS   (0 PERSISTENT_NUMBERS(COUNT_SETTING))
+#define NB_PERSISTENT_STRINGS   (0 PERSISTENT_STRINGS(COUNT_SETTING))
+
 // This defines the datatypes, names and where to store them in runtime memory
+// All the names in these tables are in flash (PROGMEM): compare with strcmp_P, print with FPSTR.
+// These values are stored in the settings journal, so add new ones at the end
 typedef enum { PERS_INT8, PERS_INT16, PERS_INT32, PERS_UINT8, PERS_UINT16, PERS_UINT32, PERS_FLOAT, PERS_STR } PERSISTENT_DATA_TYPE;
+
+// The PERSISTENT_DATA_TYPE for a C type, so the tables can't disagree with the struct
+template <typename T> struct PERSISTENT_TYPE_OF;
+template <> struct PERSISTENT_TYPE_OF<int8_t>   { static constexpr PERSISTENT_DATA_TYPE type = PERS_INT8; };
+template <> struct PERSISTENT_TYPE_OF<int16_t>  { static constexpr PERSISTENT_DATA_TYPE type = PERS_INT16; };
+template <> struct PERSISTENT_TYPE_OF<int32_t>  { static constexpr PERSISTENT_DATA_TYPE type = PERS_INT32; };
+template <> struct PERSISTENT_TYPE_OF<uint8_t>  { static constexpr PERSISTENT_DATA_TYPE type = PERS_UINT8; };
+template <> struct PERSISTENT_TYPE_OF<uint16_t> { static constexpr PERSISTENT_DATA_TYPE type = PERS_UINT16; };
+template <> struct PERSISTENT_TYPE_OF<uint32_t> { static constexpr PERSISTENT_DATA_TYPE type = PERS_UINT32; };
+template <> struct PERSISTENT_TYPE_OF<float>    { static constexpr PERSISTENT_DATA_TYPE type = PERS_FLOAT; };
+
 struct PERSISTENT_INFO_STR {
     PERSISTENT_DATA_TYPE    type;
-    char    *name;
+    PGM_P   name;
     void    *value;
+    PGM_P   field;      // in the form, or NULL
+    uint8_t form;
 };
 typedef struct PERSISTENT_INFO_STR PERSISTENT_INFO;
 extern PERSISTENT_INFO persistents[];
 
-// This defines the names and runtime storage locations for string-type data to be stored in EEPROM
+// This defines the names and runtime storage locations for string-type data
 struct PERSISTENT_STRING_INFO_STR {
-    char    *name;
+    PGM_P   name;
     char    **value;    // where to put a pointer to malloced area for the data itself
+    PGM_P   field;      // in the form, or NULL
+    uint8_t form;
 };
 typedef struct PERSISTENT_STRING_INFO_STR PERSISTENT_STRING_INFO;
 extern PERSISTENT_STRING_INFO persistent_strings[];
 
-struct NAME_MAPPING_STR {
-    char    *html_field_name;
-    char    *persistent_item_name;
-    char    *display_name;  // unused as yet. Should be used in generating the HTML form.
-};
-typedef struct NAME_MAPPING_STR NAME_MAPPING;
-extern NAME_MAPPING name_mapping[];
-
 #endif  // _GLOBALS_H
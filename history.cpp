@@ -0,0 +1,263 @@
+/* Licensed under GNU General Public License v3.0
+  See https://github.com/jeffasuk/thermostat
+  jeff at jamcupboard.co.uk
+*/
+#include <stdint.h>
+#include "history.h"
+
+// See history.h for the tiers and the /history format.
+
+#define RAW_POINTS          600     // 1 s for 10 minutes
+#define MINUTE_POINTS       180     // 1 minute for 3 hours
+#define TEN_MINUTE_POINTS   144     // 10 minutes for 24 hours
+#define MAX_FILL_SAMPLES    3600    // most missed seconds to make up in one go, if loop() was held up
+
+typedef struct {
+    uint16_t    interval_sec;
+    uint16_t    points_per_point;   // of the tier below, that make one of these
+    uint16_t    capacity;
+    int16_t     *mean;
+    int16_t     *min;               // NULL for the raw tier, where min == max == mean
+    int16_t     *max;
+    uint8_t     *on;
+    uint16_t    count;
+    uint16_t    next;               // where the next point goes
+    uint32_t    written;            // points ever added. See HISTORY_VIEW
+
+    // the point being built from the tier below
+    int32_t     sum;
+    int16_t     lo;
+    int16_t     hi;
+    uint16_t    nb_valid;
+    uint16_t    nb;
+    uint32_t    on_sum;
+} HISTORY_TIER;
+
+static int16_t  raw_mean[RAW_POINTS];
+static uint8_t  raw_on[RAW_POINTS];
+static int16_t  minute_mean[MINUTE_POINTS], minute_min[MINUTE_POINTS], minute_max[MINUTE_POINTS];
+static uint8_t  minute_on[MINUTE_POINTS];
+static int16_t  ten_minute_mean[TEN_MINUTE_POINTS], ten_minute_min[TEN_MINUTE_POINTS], ten_minute_max[TEN_MINUTE_POINTS];
+static uint8_t  ten_minute_on[TEN_MINUTE_POINTS];
+
+static HISTORY_TIER tiers[HISTORY_NB_TIERS] = {
+    {1,     1,  RAW_POINTS,         raw_mean,           0,              0,              raw_on},
+    {60,    60, MINUTE_POINTS,      minute_mean,        minute_min,     minute_max,     minute_on},
+    {600,   10, TEN_MINUTE_POINTS,  ten_minute_mean,    ten_minute_min, ten_minute_max, ten_minute_on},
+};
+
+static uint32_t nb_samples = 0;
+static uint32_t millis_at_first_sample;
+
+static int16_t toCentiDegrees(float temperature)
+{
+    float centi = temperature * 100 + (temperature < 0 ? -0.5f : 0.5f);
+    if (centi <= HISTORY_NO_DATA + 1 || centi >= 32767)
+    {
+        return HISTORY_NO_DATA;     // out of range: call it no reading
+    }
+    return (int16_t)centi;
+}
+
+static void addPoint(int tier_index, int16_t mean, int16_t lo, int16_t hi, uint8_t on)
+{
+    HISTORY_TIER *tier = &tiers[tier_index];
+    tier->mean[tier->next] = mean;
+    if (tier->min)
+    {
+        tier->min[tier->next] = lo;
+        tier->max[tier->next] = hi;
+    }
+    tier->on[tier->next] = on;
+    tier->next = (tier->next + 1) % tier->capacity;
+    ++tier->written;
+    if (tier->count < tier->capacity)
+    {
+        ++tier->count;
+    }
+
+    if (tier_index + 1 >= HISTORY_NB_TIERS)
+    {
+        return;
+    }
+    // downsample into the next tier up
+    HISTORY_TIER *up = &tiers[tier_index + 1];
+    if (mean != HISTORY_NO_DATA)
+    {
+        up->lo = (!up->nb_valid || lo < up->lo) ? lo : up->lo;
+        up->hi = (!up->nb_valid || hi > up->hi) ? hi : up->hi;
+        up->sum += mean;
+        ++up->nb_valid;
+    }
+    up->on_sum += on;
+    if (++up->nb < up->points_per_point)
+    {
+        return;
+    }
+    if (up->nb_valid)
+    {
+        int32_t up_mean = (up->sum + (up->sum < 0 ? -(int32_t)up->nb_valid : (int32_t)up->nb_valid) / 2) / up->nb_valid;
+        addPoint(tier_index + 1, up_mean, up->lo, up->hi, (up->on_sum + up->nb / 2) / up->nb);
+    }
+    else
+    {
+        addPoint(tier_index + 1, HISTORY_NO_DATA, HISTORY_NO_DATA, HISTORY_NO_DATA, (up->on_sum + up->nb / 2) / up->nb);
+    }
+    up->sum = 0;
+    up->nb_valid = up->nb = 0;
+    up->on_sum = 0;
+}
+
+/* Called every tick of loop(), which is about once a second. Any whole seconds that were missed
+   (loop() held up by a reconnect, say) are filled with this sample, so the tiers stay in step with the clock.
+   A second tick within the same second is ignored.
+*/
+void addHistorySample(uint32_t millis_now, uint8_t valid, float temperature, uint8_t on)
+{
+    uint32_t due;
+    uint32_t nb_filled = 0;
+    int16_t centi = valid ? toCentiDegrees(temperature) : HISTORY_NO_DATA;
+    uint8_t on_fraction = on ? 255 : 0;
+    if (!nb_samples)
+    {
+        millis_at_first_sample = millis_now;
+    }
+    due = (millis_now - millis_at_first_sample) / 1000 + 1;
+    while (nb_samples < due && nb_filled++ < MAX_FILL_SAMPLES)
+    {
+        addPoint(0, centi, centi, centi, on_fraction);
+        ++nb_samples;
+    }
+    nb_samples = due;
+}
+
+void getHistoryView(HISTORY_VIEW *view)
+{
+    int tier_index;
+    view->nb_samples = nb_samples;
+    for (tier_index = 0; tier_index < HISTORY_NB_TIERS; ++tier_index)
+    {
+        view->count[tier_index] = tiers[tier_index].count;
+        view->written[tier_index] = tiers[tier_index].written;
+    }
+}
+
+size_t historySize(const HISTORY_VIEW *view)
+{
+    int tier_index;
+    size_t size = 8 + 8 * HISTORY_NB_TIERS;
+    for (tier_index = 0; tier_index < HISTORY_NB_TIERS; ++tier_index)
+    {
+        size_t columns = tiers[tier_index].min ? 3 : 1;
+        size += (view->count[tier_index] * (2 * columns + 1) + 1) & ~(size_t)1;
+    }
+    return size;
+}
+
+/* The blob is produced a byte at a time into whichever part of it the web server asked for,
+   so it never has to exist in full. It's only a few kB.
+*/
+typedef struct {
+    uint8_t *buf;
+    size_t  start;      // offset in the blob of buf[0]
+    size_t  end;        // offset just beyond the last byte wanted
+    size_t  pos;        // offset of the next byte produced
+} HISTORY_CURSOR;
+
+static void put8(HISTORY_CURSOR *cursor, uint8_t b)
+{
+    if (cursor->pos >= cursor->start && cursor->pos < cursor->end)
+    {
+        cursor->buf[cursor->pos - cursor->start] = b;
+    }
+    ++cursor->pos;
+}
+
+static void put16(HISTORY_CURSOR *cursor, uint16_t n)
+{
+    put8(cursor, n & 0xff);
+    put8(cursor, n >> 8);
+}
+
+// Point number 'point' (counting from the first ever added) is still in the ring. Checked after the value
+// has been read, so a point overwritten while it was being read doesn't get through either.
+static uint8_t isStillThere(const HISTORY_TIER *tier, uint32_t point)
+{
+    return tier->written - point <= tier->capacity;
+}
+
+static void putColumn16(HISTORY_CURSOR *cursor, const HISTORY_TIER *tier, const int16_t *column,
+                uint16_t count, uint32_t written)
+{
+    uint16_t n;
+    uint32_t point = written - count;
+    if (cursor->pos + count * 2 <= cursor->start)
+    {
+        cursor->pos += count * 2;   // all before the part wanted
+        return;
+    }
+    for (n = 0; n < count && cursor->pos < cursor->end; ++n, ++point)
+    {
+        int16_t value = column[point % tier->capacity];
+        put16(cursor, isStillThere(tier, point) ? value : HISTORY_NO_DATA);
+    }
+}
+
+static void putColumn8(HISTORY_CURSOR *cursor, const HISTORY_TIER *tier, const uint8_t *column,
+                uint16_t count, uint32_t written)
+{
+    uint16_t n;
+    uint32_t point = written - count;
+    if (cursor->pos + count <= cursor->start)
+    {
+        cursor->pos += count;
+        return;
+    }
+    for (n = 0; n < count && cursor->pos < cursor->end; ++n, ++point)
+    {
+        uint8_t value = column[point % tier->capacity];
+        put8(cursor, isStillThere(tier, point) ? value : 0);
+    }
+}
+
+// Copies up to max_len bytes of the blob, starting at index, into buf. Returns how many.
+size_t readHistory(const HISTORY_VIEW *view, uint8_t *buf, size_t max_len, size_t index)
+{
+    int tier_index;
+    size_t size = historySize(view);
+    HISTORY_CURSOR cursor = {buf, index, index + max_len < size ? index + max_len : size, 0};
+    if (index >= size)
+    {
+        return 0;
+    }
+    put8(&cursor, HISTORY_FORMAT);
+    put8(&cursor, HISTORY_NB_TIERS);
+    put16(&cursor, 0);
+    put16(&cursor, view->nb_samples & 0xffff);
+    put16(&cursor, view->nb_samples >> 16);
+    for (tier_index = 0; tier_index < HISTORY_NB_TIERS; ++tier_index)
+    {
+        put16(&cursor, tiers[tier_index].interval_sec);
+        put16(&cursor, view->count[tier_index]);
+        put16(&cursor, tiers[tier_index].min ? HISTORY_HAS_RANGE : 0);
+        put16(&cursor, 0);
+    }
+    for (tier_index = 0; tier_index < HISTORY_NB_TIERS && cursor.pos < cursor.end; ++tier_index)
+    {
+        HISTORY_TIER *tier = &tiers[tier_index];
+        uint16_t count = view->count[tier_index];
+        uint32_t written = view->written[tier_index];
+        putColumn16(&cursor, tier, tier->mean, count, written);
+        if (tier->min)
+        {
+            putColumn16(&cursor, tier, tier->min, count, written);
+            putColumn16(&cursor, tier, tier->max, count, written);
+        }
+        putColumn8(&cursor, tier, tier->on, count, written);
+        if (count & 1)
+        {
+            put8(&cursor, 0);
+        }
+    }
+    return cursor.end - cursor.start;
+}
@@ -0,0 +1,53 @@
+/* Licensed under GNU General Public License v3.0
+  See https://github.com/jeffasuk/thermostat
+  jeff at jamcupboard.co.uk
+*/
+
+#ifndef _HISTORY_H
+#define _HISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Fixed-memory history of the controlling sensor's temperature and the relay state, kept in tiers:
+        1 s samples for 10 minutes
+        1 minute min/max/mean for 3 hours
+        10 minutes min/max/mean for 24 hours
+   Each tier is a ring buffer, filled by downsampling the one before as its points complete, so the
+   cost per tick is constant and nothing is ever allocated. About 4 kB in all.
+   Temperatures are int16 hundredths of a degree; the relay state is the fraction of the time it was on,
+   0 to 255.
+   No Arduino dependencies, so it can be built on the host.
+
+   /history serves it as one little-endian binary blob, laid out so that each column can be wrapped in a
+   JavaScript typed array without copying:
+        header  uint8 format (1), uint8 nb_tiers, uint16 0, uint32 seconds recorded since boot
+        per tier    uint16 interval_sec, uint16 count, uint16 flags (HISTORY_HAS_RANGE), uint16 0
+        per tier    int16 mean[count], then if HISTORY_HAS_RANGE int16 min[count], int16 max[count],
+                    then uint8 on[count], padded to an even length
+   Points are oldest first. A tier's newest point ends at the last whole multiple of its interval.
+*/
+
+#define HISTORY_NB_TIERS    3
+#define HISTORY_FORMAT      1
+#define HISTORY_HAS_RANGE   1
+#define HISTORY_NO_DATA     (-32768)    // no valid reading for that whole point
+
+/* Where the tiers were at the start of a response, so that pieces of it sent later stay consistent
+   with its length even if samples are added meanwhile. The points it covers are the same throughout,
+   but once a tier is full, each point added overwrites its oldest. A point that has been replaced by the
+   time its piece is sent goes as HISTORY_NO_DATA, with on 0, rather than as a newer point out of order.
+   So a slow client finds the oldest few points of a tier blanked out, one for each point added meanwhile.
+*/
+typedef struct {
+    uint32_t    nb_samples;
+    uint16_t    count[HISTORY_NB_TIERS];
+    uint32_t    written[HISTORY_NB_TIERS];  // points ever added to the tier, so the newest in the view
+} HISTORY_VIEW;
+
+void addHistorySample(uint32_t millis_now, uint8_t valid, float temperature, uint8_t on);
+void getHistoryView(HISTORY_VIEW *view);
+size_t historySize(const HISTORY_VIEW *view);
+size_t readHistory(const HISTORY_VIEW *view, uint8_t *buf, size_t max_len, size_t index);
+
+#endif  // _HISTORY_H
@@ -0,0 +1,338 @@
+#include <pgmspace.h>
+
+char home_etag[] = "1104f98ca0e1e87b4c29c471d9c07bc4";
+const char home_html[] PROGMEM =
+  "<html><head><meta http-equiv='Content-Type' content='text/html;charset=ISO-8859-1'><style media='screen' type='text/css'>overlaid {position:relative;display:inline;}.overlay {position:absolute;bottom:4;left:0;}</style><script language=JavaScript>var v59;var v43='data:image/png;base64,iVBORw0KGgoAAAANSUhEUgAAAAEAAAABCAIAAACQd1PeAAAAD0lEQVQIHQEEAPv/AP8AAAMBAQDHBpJvAAAAAElFTkSuQmCC';var v22='data:image/png;base64,iVBORw0KGgoAAAANSUhEUgAAAAEAAAABCAIAAACQd1PeAAAACXBIWXMAAAsTAAALEwEAmpwYAAAAB3RJTUUH4gYFFAc4U6owTgAAAAxJREFUCNdjYPjPAAACAgEAqiqeJwAAAABJRU5ErkJggg==';var v3='data:image/png;base64,iVBORw0KGgoAAAANSUhEUgAAAAEAAAABCAIAAACQd1PeAAAAD0lEQVQIHQEEAPv/AAAA/wEDAQA22QM2AAAAAElFTkSuQmCC';var v2='data:image/png;base64,iVBORw0KGgoAAAANSUhEUgAAAAEAAAABCAIAAACQd1PeAAAADElEQVQI12NgYGAAAAAEAAEnNCcKAAAAAElFTkSuQmCC';var v35='#ff0000';var v32='#00ff00';var v46='#F020D0';var v53;var ctx;var v56=[];function f7(elid){return document.getElementById(elid);}function f11(num){return ''+String.fromCharCode(num&0xff)+String.fromCharCode( (num/256)&0xff)+String.fromCharCode( (num/65536)&0xff)+String.fromCharCode( (num/16777216)&0xff);}function f13(n){var s=n.toFixed(2);var v37=s.split('.');if (v37[1]=='00'){return v37[0];}if (v37[1].endsWith('0')){return v37[0]+'.'+v37[1][0];}return s;}function f6(item_id){return f7(item_id).getBoundingClientRect().width;}function f17(v9,temp){var v51=temp-v9;var v33=Math.abs(v51);var v1=2*Math.max(1,Math.ceil(0.1+v33*2)/2);var v26=v9-v1/2;var v38=f7('e28').width/v1;f7('e27').width=((v1-1)/2)*v38;f7('e26').width=v38;f7('e30').width=(temp-v26)*v38-f7('e29').width/2;f7('e2').innerHTML=f13(temp);f7('e16').width=f7('e30').width-f6('e2')/2;f7('e21').innerHTML=f13(v26);f7('e3').innerHTML=f13(v9);f7('e18').width=(f7('e28').width-f6('e3'))/2-f6('e21');f7('e20').innerHTML=f13(v9+v1/2);f7('e17').width=f7('e28').width-f6('e21')-f7('e18').width-f6('e3')-f6('e20');}function f15(xmlStr){return new window.DOMParser().parseFromString(xmlStr,'text/xml');}function f24(valarray){ctx.clearRect(0,0,v53.width,v53.height);ctx.save();ctx.beginPath();ctx.lineWidth=1;ctx.strokeStyle='#333333';ctx.moveTo(0,v53.height/2);ctx.lineTo(v53.width,v53.height/2);ctx.stroke();ctx.beginPath();ctx.lineWidth=1;ctx.strokeStyle='#888888';ctx.setLineDash([5,3]);ctx.moveTo(0,v53.height/2+v53.height/10);ctx.lineTo(v53.width,v53.height/2+v53.height/10);ctx.moveTo(0,v53.height/2-v53.height/10);ctx.lineTo(v53.width,v53.height/2-v53.height/10);ctx.stroke();ctx.restore();ctx.save();for (var n=0;n<valarray.length;++n){if (n>=v56.length){v56[n]=[];}if (v56[n].length>=graph_width){v56[n].shift();}v56[n].push(valarray[n]);f2(v56[n]);}ctx.restore();}function f2(value_list){for(cnt=1;cnt<value_list.length;cnt++){ctx.beginPath();ctx.strokeStyle=value_list[cnt][0];ctx.lineWidth=value_list[cnt][1];ctx.moveTo(cnt-1,graph_height-value_list[cnt-1][2]);ctx.lineTo(cnt,graph_height-value_list[cnt][2]);ctx.stroke();}}function f19(num){return ((num>0)?'+':'')+num;}var v12=['#808080','#0b84a5','#6f4e7c','#ca472f'];var v7;var v45;var v15;var v16;var v40;var v24=false;function f18(){if (!v24){v24=true;f12();}var v44=v7;var v6=v44.tmp[0].t;var v41=v44.state;var v9=v44.des;var v47=v44.switchoffsetabove;var v48=v44.switchoffsetbelow;var v27=v44.mode;var v49=v9+v47;var v50=v9+v48;f7('e22').src=(v41==1)?(v27=='heating'?v43:v3):v22;f7('e23').textContent='Power '+((v41==1)?'on':'off')+' ('+v27+')';f7('e12').textContent=v9;f7('e6').textContent=v44.prec.toFixed(2);f7('e4').textContent=v44.runon;f7('e7').textContent=v44.maxrep;f7('e5').textContent=v27;f7('e8').textContent=v49;f7('e9').textContent=v50;f7('e10').textContent=f19(v47);f7('e11').textContent=f19(v48);f17(v9,v6);var v52=v44.tmp;f7('e0').textContent=v52[0].id;f7('e1').textContent=v52[0].t.toFixed(2);var v10=f7('e19');while (v10.lastChild) {v10.removeChild(v10.lastChild);}f7('e24').style.display=(v52.length<2)?'none':'block';for (var i=1;i<v52.length;++i){var v18=v12[i % v12.length];list_item=document.createElement('li');list_item.style.color=v18;list_item.innerHTML='<pre><font color=\"'+v18+'\">'+v52[i].id+'</font>&nbsp;'+v52[i].t.toFixed(2)+'</pre>';v10.appendChild(list_item);}}function f0(){if (!v7){return;}var v44=v7;var v9=v44.des;var v31=[];var v5=(v44.state==1)?v35:v32;v31.push( [v46,1,f5(v9+v44.switchoffsetabove,v9)] );v31.push( [v46,1,f5(v9+v44.switchoffsetbelow,v9)] );for (var i=0;i<v44.tmp.length;++i){var v11,line_width;if (i==0){v11=v5;line_width=2;}else{v11=v12[i % v12.length];line_width=1;}v31.push( [v11,line_width,f5(v44.tmp[i].t,v9)] );}f24(v31);}var v0=-32768;function f12(){var req=new XMLHttpRequest();req.responseType='arraybuffer';req.onload=function() {if (req.status==200&&new DataView(req.response).getUint8(0)==1){var v55=f14(req.response);f16(v55[0]);f1(v55[v55.length-1]);}};req.open('GET','/history',true);req.send();}function f14(buf){var v57=new DataView(buf);var v30=v57.getUint8(1);var v29=v57.getUint32(4,true);var v34=8+8*v30;var v55=[];for (var n=0;n<v30;++n){var v54={};v54.interval=v57.getUint16(8+8*n,true);v54.count=v57.getUint16(10+8*n,true);v54.end_sec=v29-v29 % v54.interval;v54.mean=new Int16Array(buf,v34,v54.count);v34+=2*v54.count;if (v57.getUint16(12+8*n,true)&1){v54.min=new Int16Array(buf,v34,v54.count);v34+=2*v54.count;v54.max=new Int16Array(buf,v34,v54.count);v34+=2*v54.count;}else{v54.min=v54.max=v54.mean;}v54.on=new Uint8Array(buf,v34,v54.count);v34+=v54.count+(v54.count&1);v55.push(v54);}return v55;}function f10(centi){return (centi==v0)?NaN:centi/100;}function f16(raw){var v44=v7;var v9=v44.des;var v28=Math.min(Math.floor(raw.count/2),graph_width-(v56.length?v56[0].length:0));var v42=[[],[],[]];for (var i=raw.count-1-2*(v28-1);i<raw.count;i+=2){v42[0].push( [v46,1,f5(v9+v44.switchoffsetabove,v9)] );v42[1].push( [v46,1,f5(v9+v44.switchoffsetbelow,v9)] );v42[2].push( [raw.on[i]?v35:v32,2,f5(f10(raw.mean[i]),v9)] );}for (var n=0;n<v56.length || n<v42.length;++n){var v25=(n<v42.length)?v42[n]:v42[0].map(function(v) { return [v[0],1,NaN];});v56[n]=v25.concat(v56[n] || []).slice(-graph_width);}}function f1(v54){var v4=f7('e14');var v23=v4.getContext('2d');var lo=Infinity,hi=-Infinity;for (var i=0;i<v54.count;++i){if (v54.mean[i] !=v0){lo=Math.min(lo,v54.min[i]);hi=Math.max(hi,v54.max[i]);}}if (lo>hi){return;}lo=Math.floor(lo/100-0.5);hi=Math.ceil(hi/100+0.5);f7('e15').textContent=lo+' to '+hi+' degC,'+f13(v54.count*v54.interval/3600)+' hours';var v58=v4.width/(86400/v54.interval);var x0=v4.width-v54.count*v58;function y(centi) { return v4.height-(centi/100-lo)*v4.height/(hi-lo);}v23.clearRect(0,0,v4.width,v4.height);v4.style.border='black 1px solid';for (var i=0;i<v54.count;++i){var x=x0+i*v58;v23.fillStyle='rgba(255,0,0,0.25)';v23.fillRect(x,v4.height*(1-v54.on[i]/255),v58,v4.height*v54.on[i]/255);if (v54.mean[i] !=v0){v23.fillStyle='#888888';v23.fillRect(x,y(v54.max[i]),v58,Math.max(1,y(v54.min[i])-y(v54.max[i])));}}v23.beginPath();v23.strokeStyle='#000000';v23.lineWidth=1;for (var i=0;i<v54.count;++i){if (v54.mean[i] !=v0){v23.lineTo(x0+(i+0.5)*v58,y(v54.mean[i]));}}v23.stroke();}function f9(){if (v59.status==200){v7=JSON.parse(v59.responseText);f18();}}function f5(temp,des){var v51=temp-des;var v39=v53.height/2+v53.height*v51/5;return v39;}function f4(){v59=new XMLHttpRequest();v59.onload=f9;v59.open('GET','/status.json',true);v59.setRequestHeader('Cache-Control','no-cache');v59.send();}function f22(){if (v15){v15.close();v15=null;}clearTimeout(v16);if (!v40){v40=setInterval(f4,2000);f4();}}function f3(){clearTimeout(v16);v16=setTimeout(f22,40000);}function f20(){if (!window.EventSource){f22();return;}v15=new EventSource('/events');v15.addEventListener('status',function(e) {v7=JSON.parse(e.data);v45=e.lastEventId;f18();f3();});v15.addEventListener('delta',function(e) {if (!v7){f4();return;}var v8=JSON.parse(e.data);for (var v17 in v8){v7[v17]=v8[v17];}v45=e.lastEventId;f18();f3();});v15.addEventListener('hb',function(e) {if (e.data !=v45){f4();v45=e.data;}f3();});v15.onerror=function() {if (v15.readyState==EventSource.CLOSED){f22();}};f3();}function f21(){f7('e28').src=v2;f7('e26').src=v22;f7('e29').src=v43;v53=f7('e13');graph_height=v53.height;graph_width=v53.width;ctx=v53.getContext('2d');v53.style.border='black 1px solid';setInterval(f0,2000);f20();}function f8(){if (v59.status==200 || v59.status==202){alert('Settings changed');f4();}else{alert(v59.status+' '+v59.statusText+'\\n'+v59.responseText);}}function f23(){var v19=f7('e25');var v21=v19.getElementsByTagName('input');var v36='';for (var idx=0;idx<v21.length;++idx){var v20=v21[idx];var v13=v20.getAttribute('name');if (!v13){continue;}var v14=v20.getAttribute('type');if (v14=='radio'){if (!v20.checked){continue;}}v36+=v13+'='+v20.value+'&';}v59=new XMLHttpRequest();v59.onload=f8;v59.open('GET','/settings?'+v36.substring(0,v36.length-1),true);v59.setRequestHeader('Cache-Control','no-cache');v59.send();}</script></head>\n"
+  "<body onLoad='f21()'>\n"
+  "<table border=0><tr valign=middle><td><img id=e22 height=40 width=40 style='border-radius: 50%;' /></td>\n"
+  "<td><span id=e23></span></td></tr></table>\n"
+  "<p>\n"
+  "<img id=e16 height=0 width=30><span id=e2>--</span><br\n"
+  "/><overlaid>\n"
+  "<img width=400 height=10 id=e28 />\n"
+  "<span class='overlay'>\n"
+  "<img width=0 height=0 id=e27 /><img width=10 height=10 id=e26 />\n"
+  "</span>\n"
+  "<span class='overlay'>\n"
+  "<img width=0 height=0 id=e30 /><img width=4 height=12 id=e29 />\n"
+  "</span>\n"
+  "</overlaid>\n"
+  "<br>\n"
+  "<span id=e21>--</span\n"
+  "><img id=e18 height=0 width=0><span id=e3>--</span\n"
+  "><img id=e17 height=0 width=0><span id=e20>--</span>\n"
+  "</p>\n"
+  "<v4 id='e13' height='200' width='400'></v4>\n"
+  "<br><font color='#ff0000'>&#9679;</font>/<font color='#00ff00'>&#9679;</font>Controlling sensor \n"
+  "<span id=e0>??</span> <span id=e1>??</span>\n"
+  "<br><font color='#F020D0'>&#9679;</font>Switch temperatures\n"
+  "<span id=e9>??</span>-<span id=e8>??</span>\n"
+  "<p id=e24>Other sensors:\n"
+  "<ul id='e19' style='line-height:20%'>\n"
+  "</ul>\n"
+  "</p>\n"
+  "<p>History <span id=e15></span>\n"
+  "<br><v4 id='e14' height='100' width='400'></v4>\n"
+  "</p>\n"
+  "<p>\n"
+  "Target temperature degC: <span id=e12>??</span> (<span id=e11>??</span> to <span id=e10>??</span>)\n"
+  "<br>Mode: <span id=e5>??</span>\n"
+  "<br>Precision degC: <span id=e6>??</span>\n"
+  "<br>Fan run-on time (seconds): <span id=e4>??</span>\n"
+  "<br>Max. time (seconds) between reports: <span id=e7>??</span>\n"
+  "</p>\n"
+  "<h3>Change settings</h3>\n"
+  "<v19 id=e25>\n"
+  "Target temperature degC: <input type=text size=4 name=des_temp value='' />\n"
+  "<input type=radio name=mode value=0 >heating or \n"
+  "<input type=radio name=mode value=1 >cooling\n"
+  "<br>Precision degC: <input type=text size=4 name=precision value='' />\n"
+  "<br><span style='font-size:smaller'>This gives the minimum change in temperature that will be noticed.\n"
+  "Set to a high value to give more inertia to both reporting and relay switching.</span>\n"
+  "<br>Fan run-on time (seconds): <input type=text size=4 name=fan_overrun_sec value='' />\n"
+  "<br>Max. time (seconds) between reports: <input type=text size=4 name=maxreporttime value='' />\n"
+  "<br><span style='font-size:smaller'>This forces a report to be sent after the specified time\n"
+  "even if there was no reportable event.\n"
+  "Reportable events are switching the relay on or off,\n"
+  "and a change in temperature direction (in order to capture max/min values).\n"
+  "Set zero for no timed reports.\n"
+  "</span>\n"
+  "<br><input type=button value=apply onClick='f23()' />\n"
+  "</v19>\n"
+  "</body>\n"
+  "</html>\n"
+  ;
+char home_gz_etag[] = "1104f98ca0e1e87b4c29c471d9c07bc4-gz";
+const unsigned int home_gz_len = 4317;
+const unsigned char home_gz[] PROGMEM = {
+  0x1f,0x8b,0x08,0x00,0x00,0x00,0x00,0x00,0x02,0x03,0xb5,0x5a,0x69,0x73,0xdb,0x46,
+  0xd2,0xfe,0xae,0x5f,0x81,0x6c,0x2a,0x06,0x68,0x5e,0x38,0x79,0x88,0x04,0x5d,0xb2,
+  0x2c,0xc7,0xf6,0xfa,0x96,0x9c,0xa3,0xf4,0xaa,0x5c,0x20,0x30,0x24,0x27,0x06,0x01,
+  0x06,0x00,0x29,0x69,0xbd,0xfa,0xef,0xfb,0xf4,0xcc,0x00,0x04,0x29,0xda,0x71,0x5c,
+  0x79,0x95,0x58,0x02,0xa6,0xcf,0xe9,0x6b,0xba,0x87,0x1c,0x2f,0x8a,0x65,0x3c,0x19,
+  0x2f,0x58,0x10,0x4d,0xc6,0x4b,0x56,0x04,0xda,0xa2,0x28,0x56,0x6d,0xf6,0xe7,0x9a,
+  0x6f,0x7c,0xfd,0x34,0x4d,0x0a,0x96,0x14,0xed,0x8b,0xdb,0x15,0xd3,0xb5,0x50,0xbe,
+  0xf9,0x7a,0xc1,0x6e,0x8a,0x2e,0x11,0x8e,0xc2,0x45,0x90,0xe5,0xac,0xf0,0x9f,0x9f,
+  0xbf,0x69,0x0f,0x06,0xde,0xb0,0x6d,0xe9,0x93,0x71,0x5e,0xdc,0xc6,0x4c,0x5b,0xb2,
+  0x88,0x07,0xbe,0x9e,0x87,0x19,0x63,0x89,0xae,0x15,0x60,0xa1,0x28,0xc3,0x3c,0xd7,
+  0x27,0xe9,0x86,0x65,0x71,0xc0,0x23,0xed,0xf3,0x2a,0xcd,0x79,0xc1,0xd3,0xe4,0x38,
+  0x63,0x71,0x50,0xf0,0x0d,0x1b,0x45,0x3c,0x5f,0xc5,0xc1,0xed,0x31,0x4f,0x62,0x9e,
+  0xb0,0xd1,0x5d,0x47,0x22,0xdf,0xd6,0x70,0x83,0x69,0x9e,0xc6,0xeb,0x82,0x8d,0xa6,
+  0x69,0x51,0xa4,0xcb,0x63,0x77,0x14,0xb3,0x59,0x71,0x6c,0x8e,0xee,0xc6,0x5d,0x21,
+  0x1f,0x6a,0x84,0x19,0x5f,0x15,0x5a,0x1c,0x24,0xf3,0x75,0x30,0x67,0xfe,0x8b,0x60,
+  0x13,0x9c,0x8b,0xb5,0xc9,0x26,0xc8,0xb4,0x8d,0x37,0x1c,0x89,0xbf,0xae,0xe3,0xeb,
+  0x51,0x50,0x04,0xc7,0x7c,0x09,0xb4,0xee,0x2a,0x99,0x8f,0xa6,0x41,0xce,0x7a,0x6e,
+  0x8b,0xff,0xf2,0xf8,0xcd,0xfb,0x6b,0xf3,0xdf,0x3f,0xcf,0xd3,0x13,0xfc,0xbc,0x3e,
+  0xff,0xb0,0x38,0xfb,0x30,0xa7,0xc7,0x33,0xfa,0xf5,0xf8,0xf4,0xe4,0x39,0xfe,0x9c,
+  0xbe,0x8b,0xac,0xb7,0x8c,0x16,0x9e,0x98,0xf1,0xd9,0xbb,0x5f,0xde,0x3d,0x7f,0xf6,
+  0xee,0xec,0xec,0xe4,0xed,0xa6,0x7b,0xf2,0x76,0x80,0xd5,0x57,0x8f,0x4f,0xde,0x3d,
+  0x79,0xf6,0x78,0xf5,0x62,0x73,0x22,0x48,0xe3,0xa7,0x17,0x9f,0xce,0xd7,0xef,0x96,
+  0xa7,0xa7,0xba,0x54,0xc0,0xb6,0xff,0x29,0x05,0x4e,0x7f,0x7b,0xfc,0xfc,0xd7,0xdf,
+  0x5e,0xe1,0x29,0xbf,0xc0,0xaf,0x97,0x67,0xd7,0x67,0x27,0xcb,0xd5,0xf5,0xef,0x02,
+  0xd9,0x79,0xff,0xe2,0xe2,0xc3,0x87,0x67,0xee,0xfc,0xf7,0xa7,0x4f,0x4f,0x42,0xf7,
+  0x43,0x2f,0xbd,0xbe,0x10,0xbc,0x6e,0x5e,0xbc,0x3f,0x7b,0xfa,0xe1,0xf4,0x75,0xf4,
+  0xc7,0xef,0x6f,0xff,0x78,0x4b,0x6c,0x4e,0xe6,0x67,0x27,0x7f,0xf2,0x3f,0xd9,0x8b,
+  0x6b,0x41,0xf9,0xe2,0xfd,0x07,0xef,0x2c,0xfb,0xf4,0x62,0x3e,0x9f,0xfb,0xbe,0x52,
+  0xfa,0xff,0xcf,0x68,0xf8,0xe9,0x5e,0x9f,0x3d,0x39,0x79,0x77,0x62,0xdb,0xef,0x5e,
+  0xd9,0x5f,0x32,0xda,0x3f,0x26,0xff,0x4c,0xca,0xb7,0xec,0xd7,0xf3,0xdf,0x7f,0x3e,
+  0x51,0x88,0x67,0xc9,0xeb,0xd3,0xf0,0xdf,0x5f,0x90,0xed,0x78,0xbe,0xfe,0xe3,0x6c,
+  0x66,0xe2,0xa7,0x5c,0x81,0x3a,0x3f,0x9a,0x26,0xad,0xa9,0x15,0xb7,0x87,0x95,0xa7,
+  0xa6,0x6d,0x3e,0x29,0x57,0x3c,0x47,0xfc,0x0d,0x8b,0x1b,0xf5,0xde,0xf3,0x2f,0xaf,
+  0x46,0xb3,0x75,0x12,0x52,0x44,0x6b,0xb3,0xbe,0xc1,0x62,0x1e,0x35,0x3e,0x67,0xac,
+  0x58,0x67,0x89,0x16,0xa5,0xe1,0x7a,0x89,0x74,0xeb,0xcc,0x59,0x71,0x16,0x33,0x7a,
+  0x7c,0x7c,0xfb,0x3c,0x92,0x48,0xa3,0xbb,0x2d,0x9d,0x65,0x19,0xc9,0x7a,0x59,0xd1,
+  0xe9,0x7a,0xf3,0xbc,0xc8,0x78,0x32,0xef,0xcc,0xb2,0x74,0x79,0x8a,0x04,0x3d,0x4d,
+  0x23,0x46,0x28,0x0f,0xcc,0x9b,0xd9,0xac,0x71,0x10,0xaa,0x11,0xbc,0x6b,0x7b,0xbd,
+  0xc6,0x5f,0x22,0xf5,0x3c,0xcf,0xf9,0x06,0x34,0xab,0xd7,0xef,0xf7,0x6d,0xab,0xc4,
+  0xdc,0x51,0xd8,0x31,0x92,0xc6,0x67,0xb2,0x41,0xee,0x27,0x9d,0x22,0x7d,0xca,0x6f,
+  0x58,0x64,0xd8,0x0d,0x65,0xca,0xbe,0x9f,0x77,0x90,0xff,0xbc,0x30,0xf4,0x8e,0xde,
+  0x18,0xf1,0x99,0x66,0x60,0xf1,0xd2,0xba,0x42,0xec,0xc1,0xbc,0xd5,0x46,0x69,0xd1,
+  0xbc,0x1a,0xdd,0x6d,0x11,0x3a,0x2c,0x89,0xf2,0x5f,0x79,0xb1,0x30,0x74,0xe0,0xed,
+  0x21,0x36,0xc1,0xad,0x29,0xf1,0x04,0x99,0x02,0xe6,0x75,0xcd,0x7a,0x06,0x2f,0xd8,
+  0xf2,0x63,0xcd,0x0b,0xf0,0x4a,0xb9,0x44,0x8e,0x78,0x9c,0xae,0x93,0x08,0x3b,0x3e,
+  0x8d,0x39,0xfc,0xf1,0x9e,0x85,0x85,0xd1,0xe8,0x5c,0xf3,0xa8,0x58,0xec,0x6c,0xb0,
+  0x6f,0x6c,0x86,0x2d,0x90,0xad,0xe4,0x36,0x37,0x9e,0xe5,0xd3,0x5b,0x7b,0xa3,0x4a,
+  0x8e,0xe3,0xf8,0xaf,0x82,0x62,0xd1,0x41,0x15,0x33,0x00,0x54,0x3b,0xb7,0x7c,0xfb,
+  0xa1,0x58,0x5e,0x06,0x37,0x86,0xd5,0x12,0x8f,0x21,0xe3,0xb1,0x61,0x76,0x2c,0x68,
+  0xee,0x3c,0xb4,0x1b,0xdd,0xd2,0x4a,0x76,0xcf,0xdf,0x0c,0xdb,0x1b,0xab,0x6b,0x2b,
+  0x8e,0x03,0x1f,0xaa,0xea,0xcc,0x1e,0xe8,0x4a,0xa1,0xee,0xc6,0x1a,0xc9,0xa5,0x7e,
+  0xb9,0xe4,0x1b,0xc6,0xc6,0x6a,0x5b,0xc4,0xe5,0x21,0x28,0x14,0xb8,0x57,0x81,0xab,
+  0x35,0xc7,0xdc,0x92,0x48,0xc5,0xed,0x9e,0x20,0x69,0x4b,0x92,0x61,0x25,0xc4,0x56,
+  0x4c,0xb0,0xc0,0x93,0x84,0x65,0xcf,0x2e,0x5e,0xbd,0xf4,0xc9,0xc3,0x62,0xf7,0x12,
+  0x68,0x6d,0x25,0xec,0x71,0x6f,0xc3,0xe2,0x82,0xb8,0xe2,0x63,0xdd,0x63,0x44,0xa2,
+  0x95,0x56,0xf7,0x61,0xc3,0x52,0xc4,0x60,0xab,0xf0,0x9e,0x1d,0xa4,0x0c,0xd0,0x42,
+  0x88,0x92,0x07,0x21,0x4a,0x9c,0x79,0x80,0x65,0x93,0xac,0x5a,0xf2,0xed,0xef,0xaa,
+  0xbe,0xcf,0x96,0x58,0xb5,0xf7,0x34,0xa8,0x04,0x2a,0x14,0xc8,0xd8,0x09,0x0e,0xcf,
+  0xb8,0x59,0xc6,0x48,0x9c,0x2a,0xc6,0x12,0x76,0xad,0x5d,0xf3,0x24,0x4a,0xaf,0x3b,
+  0x4f,0xde,0xbc,0x7a,0x4b,0x27,0x6a,0x86,0xb0,0x5a,0xd1,0xc3,0x53,0x64,0x96,0x4c,
+  0x32,0x45,0xd5,0x92,0x67,0x28,0x5e,0x76,0xd9,0xda,0xae,0xb1,0x09,0xe2,0x20,0xcb,
+  0x82,0xdb,0xc6,0x67,0xd4,0x98,0x4e,0x18,0xb3,0x20,0x13,0x11,0x6a,0xb6,0xcc,0x16,
+  0xaa,0x8f,0xd4,0x4e,0x3c,0x2d,0x18,0x9f,0x2f,0x8a,0xc6,0x88,0xf0,0xf2,0x60,0xc3,
+  0x0c,0xf9,0x38,0x65,0x73,0x9e,0xbc,0x45,0xd8,0xa9,0x77,0x3a,0x7d,0x7f,0x15,0x9b,
+  0xb7,0x24,0x6a,0x91,0xa5,0x9f,0xd8,0x39,0x1d,0xaf,0x28,0x6e,0x8e,0xf8,0xd1,0x05,
+  0x64,0x89,0x13,0xfa,0x22,0x35,0xcc,0x1a,0x77,0xb2,0x61,0xc9,0x04,0xa0,0x43,0x0a,
+  0x94,0x28,0x92,0xef,0x77,0x29,0x31,0x10,0x3f,0x52,0x09,0x34,0x22,0x2f,0x81,0xfc,
+  0x24,0xc8,0x17,0xc6,0xa5,0xd7,0x72,0xae,0x1a,0x5f,0xd6,0xad,0x59,0x7b,0xb1,0xcc,
+  0x6f,0xd0,0xf4,0x10,0xc1,0x41,0xce,0xed,0xbf,0xcb,0xf9,0x10,0xc1,0x8e,0x45,0x32,
+  0x96,0x17,0x69,0x56,0xbe,0x29,0x7f,0xcd,0xd2,0x0c,0x65,0x0f,0xa9,0x9f,0xf8,0xe6,
+  0x28,0x19,0x97,0xbe,0xef,0xc4,0x2c,0x99,0xa3,0x1a,0x35,0x9b,0x28,0xb1,0x54,0x19,
+  0x93,0x89,0x8f,0x93,0x46,0x2d,0xa3,0x1c,0x79,0xbd,0xcb,0xe4,0x8a,0x0e,0x1e,0x59,
+  0x37,0xc5,0xab,0x82,0x4e,0xfc,0x79,0x16,0xac,0x16,0x1f,0x85,0x8a,0x25,0x6a,0x27,
+  0x5f,0xf0,0x19,0xaa,0xdc,0xe8,0x4e,0xbd,0xaf,0xd6,0x30,0x6f,0x29,0x0e,0x0b,0x50,
+  0xc5,0x56,0x7c,0x80,0xb4,0xab,0x6f,0x3d,0x3e,0x89,0x66,0xcd,0x3e,0xc6,0x3c,0x2f,
+  0x1a,0x9f,0xa1,0xbd,0x11,0xa2,0x95,0x84,0x4b,0x93,0x62,0xbc,0x85,0x94,0xea,0x63,
+  0xb5,0xd9,0x94,0x71,0xbc,0x1f,0x0f,0x75,0xff,0x6f,0x09,0x2f,0x41,0x21,0xea,0xfa,
+  0x6e,0xc8,0xec,0x23,0x58,0x57,0x75,0xc7,0x61,0xa9,0x6d,0xb5,0xe4,0xa6,0xa5,0x03,
+  0xda,0xbb,0x04,0x6d,0x9c,0x15,0xf6,0xd5,0x8e,0x0f,0xb1,0xfa,0x35,0x8a,0x2d,0x7e,
+  0xe5,0xc2,0xbb,0x7a,0xf2,0x0f,0x77,0xce,0x6a,0x83,0xde,0x26,0x66,0xe3,0x91,0xde,
+  0xd4,0x8f,0x75,0xbd,0xd1,0xc4,0x2b,0x0c,0x2d,0x0e,0x03,0xdb,0xbf,0x44,0x78,0x9b,
+  0xf4,0x9f,0xde,0x42,0x73,0x31,0x1d,0xb8,0x81,0x47,0x4f,0xbd,0x99,0xcb,0xfa,0x21,
+  0x3d,0x85,0x81,0xdb,0xb7,0x67,0xfa,0x95,0x3c,0x02,0xfa,0xaa,0xf1,0xf0,0xd4,0x69,
+  0x52,0xfe,0xed,0xa9,0x75,0x53,0x9d,0x1c,0xae,0x3f,0x0b,0xe2,0x9c,0xd5,0x3a,0x0f,
+  0x6b,0x60,0xc8,0x60,0xf9,0x01,0x50,0x38,0x1e,0x28,0x45,0xb6,0x06,0x86,0x65,0x0b,
+  0xc7,0x0b,0x72,0xd7,0x2f,0x25,0xe0,0xe8,0x71,0xdd,0x4e,0xb1,0x5c,0xc1,0xde,0x9d,
+  0x42,0x71,0xb7,0xc4,0x62,0x5e,0x04,0xe8,0xc9,0xc5,0xca,0x50,0x2c,0x44,0x2c,0x57,
+  0x08,0x7d,0x89,0x70,0xcd,0x8b,0x70,0x91,0xce,0x66,0x48,0xd6,0x60,0x0a,0x37,0x28,
+  0xe8,0xe0,0x1e,0x74,0xca,0xe2,0xf4,0x5a,0xa9,0x2c,0x69,0x97,0xe8,0x2e,0x14,0x3a,
+  0x98,0xa3,0x4e,0xbb,0x4a,0x21,0xcf,0x94,0xaf,0xe5,0x89,0x46,0xa7,0x51,0x9e,0x85,
+  0xbe,0x41,0x6a,0xf9,0x56,0xe3,0x91,0x41,0x2c,0x7c,0x1d,0x53,0x4e,0x81,0x4a,0xaa,
+  0x3f,0x42,0xcf,0x7f,0xbc,0x71,0x1a,0xc7,0x68,0xbd,0x15,0x09,0x9d,0x2d,0x54,0x58,
+  0x4f,0xcb,0x19,0xe7,0x6d,0x7a,0xcd,0x32,0x4d,0x6f,0x1a,0x15,0x13,0x3d,0x4d,0xe0,
+  0x24,0x28,0x07,0x3f,0xe9,0x9a,0x81,0x66,0xc2,0xee,0x37,0xf5,0x86,0xae,0x4e,0x0a,
+  0x7b,0x8f,0x03,0xce,0x7a,0x01,0xe8,0xed,0xaf,0x63,0x27,0xab,0x8c,0x85,0xf5,0xc6,
+  0x47,0x20,0xba,0x07,0x10,0xb3,0x75,0x92,0x26,0x12,0xdc,0x3f,0x00,0x46,0xa3,0x90,
+  0xb1,0x95,0x84,0x7b,0xfb,0x70,0xbb,0x2f,0x01,0x83,0x7b,0x84,0x4a,0xb3,0xe1,0x3e,
+  0xc0,0x33,0xd5,0x5e,0xcc,0x3d,0x08,0xc5,0x2d,0xac,0x5d,0x1e,0x8a,0xd6,0x41,0xf0,
+  0x00,0x60,0xd9,0xf9,0x6c,0x7a,0xaa,0x4b,0xf1,0xec,0x32,0x54,0x24,0xa5,0x79,0x4f,
+  0xa2,0x4d,0x31,0xc4,0x23,0xc5,0xf8,0x30,0xb8,0xb8,0xd7,0x23,0x5a,0xa6,0x3c,0x8e,
+  0x2d,0x6c,0x61,0x74,0xbd,0xe0,0x18,0x37,0xd1,0xd9,0x98,0x9d,0x38,0xc8,0x8b,0x53,
+  0xbc,0x46,0x0d,0xed,0x33,0xbd,0x67,0x8c,0x32,0x5d,0xac,0xec,0xc1,0x51,0x9a,0x84,
+  0xdf,0xc9,0xe8,0x62,0x5e,0xec,0xa8,0xa1,0x13,0x41,0xe3,0xd9,0xaa,0x0c,0x8d,0x6d,
+  0x78,0x1d,0x0e,0x60,0xf0,0xfb,0x34,0x4e,0xc3,0x4f,0xfa,0xb6,0xec,0x72,0xd4,0x2e,
+  0x3e,0xde,0xe2,0xa2,0xe2,0x72,0xd5,0xed,0x59,0x08,0x66,0xcb,0xbe,0xe4,0xda,0x4f,
+  0x94,0xc6,0x0a,0x7e,0x35,0xa2,0x12,0xf1,0x91,0x9a,0x49,0xbf,0x6a,0xed,0x31,0x1b,
+  0x23,0x5f,0x54,0x77,0x6f,0xe8,0x31,0xc7,0x76,0x2a,0x34,0xa5,0x57,0x98,0xc6,0x69,
+  0x06,0x86,0x83,0x1a,0x64,0xdb,0xb2,0xe8,0x63,0xc4,0xd2,0x64,0x3c,0x83,0xc5,0x34,
+  0x89,0xf9,0x2f,0x04,0xa6,0x35,0x68,0xea,0xff,0x9a,0xe0,0x01,0x06,0xe4,0x64,0xdf,
+  0xa6,0x3e,0xee,0x12,0xce,0xe4,0x41,0x32,0xcd,0x57,0xa3,0x0a,0x52,0x37,0x2d,0xe1,
+  0x10,0x33,0x8c,0x2b,0x30,0x55,0xb0,0x5a,0xa1,0x9b,0x96,0xa6,0xab,0x04,0xef,0x16,
+  0x33,0xb3,0xaa,0x1a,0xfd,0xb2,0xa2,0xdd,0x2f,0x16,0x7b,0x65,0xc0,0xb1,0xe8,0xec,
+  0x91,0xc1,0x41,0xf9,0xa9,0x4a,0x86,0x48,0x30,0xcc,0x55,0xc8,0x4a,0x34,0xb4,0x8e,
+  0x25,0x4f,0x19,0xed,0x12,0x63,0x54,0xcb,0x6a,0xcd,0x3c,0xd1,0x96,0x1d,0x2a,0x1f,
+  0x2d,0xb4,0x80,0x57,0x5a,0xe3,0x5b,0x69,0x44,0x51,0x29,0x69,0x6a,0xbe,0x34,0xc9,
+  0x97,0x32,0x52,0x0f,0xf8,0xd3,0x6a,0x51,0xf1,0x97,0xe7,0xa2,0x98,0x47,0xb8,0xef,
+  0x9b,0x00,0x5a,0x28,0x7a,0xde,0x68,0x0b,0xf3,0xed,0xd1,0x1d,0x43,0x69,0x95,0x90,
+  0x83,0x21,0x50,0xa1,0x5a,0x30,0x55,0x4d,0xe7,0x1d,0x19,0x42,0x79,0x55,0x62,0xc9,
+  0x49,0xa5,0xc2,0x77,0xa2,0xcb,0x73,0xac,0xb2,0x26,0x9b,0x7e,0xdb,0xb1,0xfb,0xbd,
+  0x41,0xbd,0x94,0xa3,0x62,0x0b,0xad,0x33,0xf6,0xa7,0x4f,0x8d,0xe5,0x6f,0xaf,0x5e,
+  0x3e,0x2b,0x8a,0xd5,0x7b,0xf6,0xe7,0x1a,0xc7,0x32,0xca,0x39,0x00,0x74,0x42,0xaf,
+  0xd2,0x24,0x67,0x17,0xe2,0x52,0x46,0x9c,0xe4,0xd3,0xf5,0x6c,0xc6,0x32,0x5d,0x80,
+  0xd3,0x24,0x4e,0x83,0xc8,0x2f,0xb9,0x1a,0xc8,0x26,0xda,0x35,0x81,0xc8,0x5b,0xeb,
+  0xdc,0xf7,0x6d,0xd3,0x7c,0xf0,0x80,0xf8,0x3f,0xc1,0x10,0xfe,0x0b,0x67,0xd7,0x46,
+  0x9d,0xaf,0x98,0x95,0x3e,0xf0,0xa4,0x18,0x18,0x66,0x83,0x7c,0xab,0xc6,0x20,0x0f,
+  0xa5,0xc2,0xdd,0xc5,0x44,0xcd,0xe8,0x21,0xe5,0x3c,0x24,0x3a,0x3d,0x8b,0x47,0xfc,
+  0x53,0x26,0xc3,0x01,0x4c,0x31,0x27,0xb5,0x42,0x40,0x1a,0xfa,0xcf,0x67,0x17,0x38,
+  0xfa,0xba,0x0b,0x4e,0x3d,0xc6,0xad,0xde,0xa2,0x83,0x4a,0x6e,0x2a,0x47,0xbc,0xee,
+  0xf6,0x1c,0x90,0x85,0x6d,0x95,0xc2,0xfb,0xfe,0x8e,0xbe,0x04,0x51,0x31,0x89,0xe3,
+  0xc3,0xeb,0x6f,0x55,0x2e,0xe7,0x31,0x7b,0x58,0x5f,0x77,0x6c,0xc3,0x55,0xd2,0x24,
+  0x95,0xeb,0x0f,0x9a,0x03,0x0c,0x45,0xea,0x5c,0xc5,0xe6,0x68,0x9c,0xdf,0x6b,0xcb,
+  0x00,0x15,0xad,0x98,0x44,0x71,0xfd,0xcf,0x77,0x23,0xfc,0x41,0x02,0x17,0x2c,0x43,
+  0xe7,0x50,0x17,0x00,0x3b,0x10,0xc3,0xa4,0x14,0x02,0xb4,0x10,0xe3,0x66,0xb1,0x87,
+  0x63,0x99,0x7b,0x48,0xd8,0xf6,0xc7,0x9c,0x85,0x28,0xf8,0x18,0x08,0xed,0x21,0x85,
+  0x5c,0x4d,0x82,0x40,0x59,0xb2,0x20,0x11,0xbb,0x7f,0x4e,0x2c,0x4e,0xc8,0xdf,0xb4,
+  0xff,0x16,0x36,0xd1,0xaa,0xe4,0x50,0x12,0xb9,0x4d,0xcc,0xa0,0xd5,0x8a,0x9c,0xbd,
+  0x77,0xa5,0xdb,0x5b,0xe9,0x0f,0xc8,0xaf,0xc4,0x9d,0x7f,0x17,0x73,0x41,0x1a,0xdc,
+  0x7c,0x0f,0xa9,0xca,0x32,0x25,0xbb,0x64,0x54,0xee,0x94,0x5a,0x55,0x17,0x41,0x2c,
+  0x38,0x0b,0x97,0x7e,0x9d,0x73,0xf5,0xde,0x34,0xaa,0xc7,0x07,0x14,0x04,0x08,0x43,
+  0xd9,0xed,0x7a,0x6e,0xa3,0xba,0x30,0xc0,0xea,0x4e,0x8c,0x99,0x46,0x88,0xe2,0xcd,
+  0xb7,0x3d,0x9d,0x78,0xf5,0xfd,0x0d,0xda,0xba,0xd7,0xc1,0xeb,0x63,0xf1,0x8a,0xc6,
+  0xde,0xdc,0xa1,0xea,0x19,0x59,0x70,0xad,0xc2,0xe2,0xcb,0xd5,0xd2,0x1e,0xc8,0x7b,
+  0x02,0xec,0xd2,0x10,0x0f,0xb3,0x38,0x45,0xe7,0x0c,0x52,0xa9,0x25,0x06,0xa8,0x56,
+  0xad,0x67,0x6f,0x1b,0xdb,0x56,0xff,0x11,0xb5,0xe4,0x66,0xd9,0xda,0x1f,0x9b,0x0d,
+  0x15,0xb6,0x2e,0xfa,0xca,0xcb,0xab,0x96,0xf8,0xff,0xaa,0x5e,0x02,0x2b,0xa6,0x6d,
+  0xab,0x6d,0x3f,0x44,0xc7,0x34,0x68,0xc3,0x06,0x7c,0x5c,0xad,0x8f,0x38,0x9c,0x00,
+  0x95,0x5d,0x71,0x28,0xff,0xed,0x02,0x0d,0x32,0xeb,0xea,0x6f,0xd7,0x68,0x22,0xb3,
+  0x2b,0x32,0xd2,0x25,0x4d,0x50,0x13,0xcb,0xb3,0xa2,0x65,0x13,0x13,0x72,0x02,0x81,
+  0xc8,0xf9,0x00,0x36,0xb6,0xf5,0x72,0x2f,0x1b,0x2b,0xeb,0x68,0xff,0xfd,0xaf,0x86,
+  0x77,0xd7,0xde,0x99,0x97,0xa4,0xcd,0x71,0x2e,0xd5,0x41,0x38,0x97,0xa0,0x43,0x72,
+  0x75,0xac,0x36,0xbe,0x0c,0x56,0x46,0x55,0x19,0x37,0x28,0x8d,0x9a,0x72,0xfc,0xe5,
+  0x06,0x60,0xec,0x0a,0x4e,0xc7,0x74,0x45,0xe1,0x23,0x46,0x2d,0x30,0x84,0xfd,0x92,
+  0x30,0x28,0xd4,0x94,0x44,0xb2,0x2f,0xaf,0xd0,0x76,0xc4,0x3c,0x64,0x46,0xbb,0x3e,
+  0x73,0xed,0xce,0x0a,0x22,0xee,0x54,0x88,0xa8,0x7e,0x07,0xed,0x8a,0x8a,0x0c,0x07,
+  0x91,0x42,0x79,0x29,0x7a,0xa5,0x1b,0x34,0x0f,0x76,0xa4,0x60,0x71,0xea,0x3f,0x4f,
+  0x66,0x3c,0xe1,0xc5,0x6d,0x6b,0xc1,0xfd,0x76,0xf9,0x72,0xef,0xbc,0xab,0xd2,0x49,
+  0x1c,0x75,0x32,0xd7,0xdd,0xd2,0x88,0xda,0x0f,0x14,0xc1,0x9f,0xc1,0xac,0x8a,0xc0,
+  0x38,0x6d,0xa9,0x94,0x23,0x23,0x8f,0xc0,0xbb,0xba,0xad,0x5a,0xf0,0x96,0xca,0x42,
+  0x01,0xba,0x13,0xc3,0x65,0x9c,0x4e,0x16,0x7c,0xdb,0x19,0x94,0xac,0x64,0x0c,0xc7,
+  0x29,0xe5,0x44,0xdb,0xec,0x78,0x5b,0x4e,0xe2,0xb2,0x6b,0x21,0x92,0xa5,0x29,0x00,
+  0x72,0xd3,0xfb,0x9d,0x6d,0x9c,0xa2,0xff,0x2e,0x52,0x34,0xe7,0x0b,0x8e,0xa7,0x88,
+  0xcd,0x4f,0x5b,0x7a,0x53,0x5c,0xde,0x94,0x5b,0x7a,0x58,0x2f,0x81,0x5d,0xa7,0x67,
+  0x9a,0xd4,0xb3,0x2f,0xd2,0x75,0x96,0x97,0xb7,0xb1,0x34,0x71,0xa8,0x4b,0x2c,0x63,
+  0xd0,0x73,0x4d,0xb3,0x5b,0xa7,0x91,0xa6,0xbc,0x31,0x2b,0xa4,0x76,0x9d,0x77,0xed,
+  0xc4,0xbd,0x55,0xe9,0xbf,0x8d,0x03,0x50,0xa8,0xd1,0xd0,0xa8,0x72,0xbf,0x1d,0xa7,
+  0x8d,0x87,0x15,0xa0,0x8b,0x4d,0xd2,0x0a,0x0a,0x95,0xed,0xec,0x5f,0xd4,0xb8,0xe5,
+  0x15,0x81,0x5b,0x5d,0xd3,0x6c,0x5c,0xd5,0x0b,0x4e,0xd3,0x2c,0x62,0x99,0x8f,0x66,
+  0x34,0x08,0x3f,0x69,0xd6,0xea,0x46,0xcb,0xd3,0x98,0x47,0xfa,0x5f,0xb8,0x56,0x6c,
+  0xc5,0xbf,0x31,0x9b,0x5c,0xe8,0x4e,0x42,0x67,0x3c,0x8e,0xd5,0x1d,0x4a,0x36,0x9f,
+  0x06,0x86,0xed,0x79,0x2d,0x12,0x6f,0x76,0x6c,0x0f,0x23,0x4d,0x89,0x22,0xd4,0xba,
+  0xd9,0xea,0xf2,0xd0,0xb0,0xda,0xb2,0xb8,0xc2,0xcf,0x5d,0x10,0x21,0xd7,0xbc,0x41,
+  0x0d,0xbe,0x0b,0x1c,0x1d,0x0e,0xaa,0x3d,0x05,0xaa,0x4b,0x9c,0x3d,0xa9,0xb7,0x46,
+  0x2d,0xa6,0x84,0x9c,0xda,0xed,0xa8,0x02,0xca,0x58,0x6c,0xef,0xa0,0x36,0x28,0x00,
+  0x89,0x57,0xfd,0xea,0x80,0xde,0x77,0xaf,0x8e,0x4c,0x53,0x5d,0xe0,0x03,0x52,0xbf,
+  0x64,0xfa,0x9e,0x34,0x29,0x79,0x5c,0xa4,0x06,0xcc,0x6c,0x70,0x11,0xbe,0x64,0xec,
+  0x52,0x4f,0x55,0x99,0x4a,0xcd,0xb6,0x97,0x03,0xdb,0x7c,0x1f,0x1a,0x25,0xf7,0x61,
+  0xbd,0xcd,0x02,0xf3,0xbe,0xff,0xe2,0xfc,0xcd,0x6b,0x79,0x21,0x28,0xc0,0x55,0xff,
+  0x86,0xac,0xa0,0xae,0x69,0xb0,0x77,0xcd,0xe0,0x89,0xeb,0xd7,0x16,0xce,0x91,0xbd,
+  0x0b,0xe8,0x6d,0x1f,0x4e,0xbd,0xcd,0xc1,0xdb,0x2d,0x68,0x6d,0x75,0xbd,0x51,0x75,
+  0x77,0x3e,0xac,0xeb,0xe8,0x52,0x77,0xe9,0x0d,0x0f,0x77,0x96,0xa4,0x59,0xd9,0x3a,
+  0x0e,0xe5,0x5b,0xbd,0x65,0x93,0x7b,0xea,0xfc,0x91,0x63,0x8e,0xae,0xda,0x97,0x21,
+  0xdd,0xda,0x29,0x16,0xcf,0x58,0x80,0xe8,0x36,0xf4,0xd3,0x20,0x5c,0xb0,0x36,0x65,
+  0x7b,0x96,0xc6,0xa0,0x4c,0xd2,0x76,0x48,0x4b,0x7a,0x49,0xb0,0xdf,0xe7,0xd9,0x76,
+  0x69,0x3a,0xcb,0xa3,0xb6,0x1c,0x05,0x37,0x4e,0x73,0x32,0x2f,0x9e,0xfd,0x64,0x1d,
+  0xc7,0xa3,0x3b,0x91,0x65,0x17,0x7c,0xc9,0xd2,0x35,0x0a,0xb1,0xd5,0x93,0xb1,0xf9,
+  0xc3,0xc6,0x25,0x03,0xbb,0xa6,0x0f,0x35,0x9e,0xab,0xdc,0x37,0x66,0x6e,0x0b,0x86,
+  0x37,0x61,0x59,0x77,0xcf,0xb0,0x0e,0x04,0xdd,0xe7,0x84,0x5f,0x44,0x5f,0xae,0x41,
+  0x9f,0x96,0x6b,0x0a,0x06,0x75,0x25,0xab,0x71,0x49,0xdd,0xf5,0x9e,0x6d,0x50,0x1d,
+  0xce,0x51,0x92,0x42,0xd6,0xf8,0x2c,0xf6,0x30,0xaa,0x86,0x28,0x52,0x1b,0x26,0xae,
+  0xa1,0x18,0x7a,0x97,0xd1,0x5b,0xae,0x8b,0x5d,0x75,0x82,0x28,0x12,0xd0,0x97,0x68,
+  0x84,0x59,0x42,0x66,0x93,0xf6,0xd5,0x5b,0xd5,0xe1,0xc4,0x68,0x0a,0xde,0x89,0x1d,
+  0x4c,0xb9,0x68,0x7f,0xa9,0xa0,0x78,0x3e,0x13,0xd3,0xb0,0xe0,0xf1,0x3c,0x52,0x31,
+  0x44,0xfb,0x13,0x47,0xd7,0x41,0x01,0x11,0x8b,0x8b,0x60,0x8f,0x7f,0x35,0xff,0x09,
+  0x53,0xed,0x0c,0x81,0x83,0x43,0x92,0xab,0xe4,0xda,0x58,0x7d,0x8d,0x23,0xbe,0x06,
+  0x14,0xdf,0x98,0x7f,0xfa,0x38,0x29,0x07,0xe2,0x2f,0xc8,0xbf,0x4b,0xbd,0xc5,0xf4,
+  0x80,0x6e,0x52,0x2e,0x65,0xa9,0xeb,0x29,0x25,0x25,0x77,0x5a,0x86,0x7b,0x6a,0x1c,
+  0x31,0xe7,0x67,0x19,0x06,0xe8,0xfd,0xb1,0x87,0x60,0x98,0xd3,0xa3,0xdb,0x73,0x39,
+  0xa9,0xd6,0x9c,0xd2,0x39,0x7d,0xf9,0xe6,0xfc,0xec,0x49,0xe9,0x3e,0x0c,0x2a,0x92,
+  0x61,0xcd,0xeb,0x16,0xbc,0xbe,0xfd,0xe8,0x80,0x6e,0xa5,0x36,0x76,0xed,0x83,0x17,
+  0xb9,0x50,0xae,0x0c,0xcb,0x15,0xd7,0x41,0xa8,0x3b,0xea,0xd0,0x77,0xe0,0xf2,0xfa,
+  0x95,0x63,0x2d,0x73,0x47,0xb5,0xee,0xc1,0xaf,0xae,0x97,0xe9,0xfe,0x51,0xbc,0xdd,
+  0xef,0x0f,0x3c,0xe7,0xaf,0x8e,0x92,0x9d,0x44,0x30,0xcb,0x44,0xa0,0xe8,0xad,0xef,
+  0x6b,0x70,0xb8,0x58,0x51,0x6f,0xb3,0xbb,0x84,0x8e,0x31,0x88,0x59,0x06,0x05,0xce,
+  0x59,0x41,0xb7,0x6f,0xb9,0x16,0x2e,0x82,0x64,0xce,0x48,0x1d,0x99,0x5f,0xa2,0x99,
+  0x97,0x48,0x5b,0x5a,0x1c,0xd7,0x74,0x4b,0x51,0xbe,0x52,0xa5,0x6b,0xea,0xff,0x97,
+  0xc8,0xb5,0xdd,0xfa,0x57,0x4f,0x50,0xdb,0x31,0xca,0xa9,0x7d,0xa8,0x3e,0xb2,0xf1,
+  0xaa,0x9e,0x89,0x86,0xf2,0x61,0xed,0xf3,0xd4,0xfc,0xf1,0xed,0x45,0x30,0x7f,0x1d,
+  0x2c,0x91,0x5d,0x3c,0x59,0xad,0x8b,0x12,0xd3,0xe9,0xf9,0x7a,0xfd,0x50,0x8d,0x6e,
+  0xe8,0x28,0x88,0x6e,0xc6,0xe0,0x51,0xbb,0x1f,0x88,0x6e,0xca,0x9e,0x11,0x7d,0x82,
+  0x6d,0x5d,0x62,0x41,0xdd,0x6d,0x58,0x68,0xcf,0x6c,0x93,0x44,0x9d,0x14,0x45,0xc6,
+  0xa7,0xeb,0x02,0x22,0x12,0x08,0xd2,0xcb,0xba,0x63,0x39,0xa8,0x24,0xf0,0x0d,0x4f,
+  0xd6,0xac,0xbc,0xf2,0x75,0x0f,0x10,0xd1,0xf7,0x26,0xca,0x4f,0x41,0x81,0x80,0xe3,
+  0x3a,0x88,0x78,0xaa,0x57,0xf7,0xb5,0x66,0x07,0x95,0x31,0xfc,0xc4,0xa2,0x3a,0xbb,
+  0x3b,0xec,0x00,0x73,0x8d,0xe5,0x34,0x75,0x9f,0xee,0x29,0xcd,0x8e,0xb8,0xa5,0x6e,
+  0xea,0x0f,0x74,0x1a,0x8e,0xbe,0xa1,0x7e,0x0f,0x0e,0xd4,0x6f,0xe5,0xbf,0x47,0xf4,
+  0x31,0x6a,0xaf,0x93,0xaf,0xa7,0xb9,0xfc,0x60,0x0a,0x4d,0x8b,0xd3,0xab,0x06,0xf6,
+  0xc6,0x3f,0x51,0xdb,0xc7,0x5d,0xf9,0xed,0x8d,0xc9,0xb8,0x2b,0xbe,0x9a,0x72,0x34,
+  0x9e,0xa6,0xd1,0xad,0x96,0x26,0x2f,0x49,0x3b,0x5d,0xa4,0x95,0x8e,0x55,0xcc,0x18,
+  0x31,0xd3,0x54,0x2c,0x9b,0x93,0x71,0x01,0x33,0x06,0x31,0x9f,0x27,0xfe,0x92,0x47,
+  0x11,0x7d,0x0b,0xa4,0x88,0x26,0x63,0xbe,0x9c,0xc3,0x87,0x3e,0xb3,0x6d,0x4d,0x65,
+  0x90,0x6b,0x6a,0x32,0x67,0xf0,0x90,0xcb,0x7e,0x40,0x32,0x69,0x93,0x79,0xd7,0xf9,
+  0xb1,0xe6,0x99,0x3f,0x8d,0x74,0xad,0x0b,0x05,0x0a,0x12,0x4f,0x6c,0xf2,0x55,0x90,
+  0x48,0x3e,0x0e,0x96,0xe9,0x4d,0x42,0xf1,0x2b,0xa3,0x5f,0xa4,0x0b,0x50,0x57,0xf8,
+  0x57,0x4a,0xb4,0x7a,0xa5,0xc4,0x52,0xa0,0x63,0xd6,0x19,0x4d,0xda,0xed,0x92,0xd3,
+  0x34,0x3b,0x82,0xb4,0xf2,0x6b,0x31,0x8a,0x47,0xa9,0xa4,0x59,0xb2,0xb1,0x4c,0x49,
+  0x38,0x80,0x6a,0x47,0x92,0x51,0x88,0x42,0x99,0xfb,0xba,0xfa,0x8e,0x8c,0xbe,0x43,
+  0x69,0x6e,0xc5,0x0b,0xb2,0x3e,0xed,0x68,0x0b,0xb6,0xee,0xf1,0xed,0x09,0xbe,0x52,
+  0xa5,0xbf,0xcf,0xdf,0x31,0x77,0xf9,0xbb,0x15,0x7b,0x5b,0xb2,0x1f,0xee,0xb0,0xef,
+  0xd6,0x76,0x3b,0xcd,0x4a,0x79,0x02,0xd1,0xaa,0x2c,0x73,0xb4,0xf5,0x9f,0x35,0xd8,
+  0xb7,0x66,0xdd,0x98,0xce,0x41,0x92,0xfe,0xd7,0x48,0x6c,0x73,0xeb,0x00,0xa8,0x43,
+  0x9e,0xdb,0xb8,0x04,0x11,0x55,0xb7,0xa4,0xd4,0x51,0xd8,0x74,0x45,0xad,0xc3,0x17,
+  0x3a,0x9c,0xbd,0x71,0xa5,0xce,0xf5,0x9b,0xd7,0xea,0x3b,0x21,0x93,0x07,0x3f,0x0e,
+  0x7b,0xfd,0xe1,0x48,0xdd,0xb9,0x76,0x77,0x91,0xd4,0xd7,0x44,0xf6,0x90,0x54,0x4a,
+  0xa0,0x89,0x9c,0x6b,0xc8,0x82,0x1c,0xb5,0xa7,0x66,0x0f,0x73,0xf2,0xe8,0x91,0xd2,
+  0x53,0xdb,0xae,0x5a,0xdb,0xd5,0x03,0xca,0xa8,0x2f,0x9f,0xec,0xc9,0x39,0x17,0x93,
+  0xb6,0x46,0xdd,0x20,0xcb,0x50,0x59,0x51,0x4a,0x6b,0x72,0x86,0x5b,0x8e,0xed,0xed,
+  0xea,0xa0,0x2e,0x67,0x25,0x2d,0xe7,0x4e,0xde,0x14,0x0b,0x96,0x29,0x5d,0xf3,0xe3,
+  0xa3,0xf1,0x3a,0x56,0x96,0x1b,0xea,0x65,0x4e,0x51,0x4b,0xdc,0x96,0x56,0x3c,0xb6,
+  0xcd,0x9f,0x28,0x76,0xba,0xeb,0xb8,0x34,0xf5,0x6a,0xf2,0x4c,0xde,0xe2,0xd5,0xb7,
+  0xe4,0x4d,0x76,0x76,0x54,0xb9,0xc3,0xdd,0xba,0xc3,0xfa,0x82,0x3b,0x14,0xd3,0xa3,
+  0x8b,0x20,0x43,0x0d,0xad,0x6f,0x51,0xcc,0x88,0xc7,0x75,0x31,0x76,0xcd,0xa0,0x46,
+  0x6d,0xbd,0x66,0x52,0x1a,0x31,0x6b,0x90,0x9a,0x0b,0x1a,0x42,0xb7,0x57,0x69,0xc4,
+  0xea,0x3c,0xbd,0x3d,0x6f,0xbc,0xcd,0x58,0xc8,0x73,0x3a,0x95,0xf6,0xa5,0xf7,0xf6,
+  0x30,0x9f,0x62,0x3d,0x5b,0x27,0x6d,0xa0,0x16,0xe8,0x21,0x35,0x23,0x67,0xa8,0xe5,
+  0x51,0xde,0xa8,0x13,0xb9,0x7b,0x44,0xaf,0x82,0x9b,0xce,0x1e,0xba,0x36,0x65,0xc5,
+  0x35,0x63,0x60,0xc6,0x56,0x69,0x56,0xe4,0x75,0xf2,0x7e,0x9d,0x5c,0x58,0x6a,0xe1,
+  0x4c,0x4e,0xc5,0x49,0xac,0x95,0x95,0x1d,0xc5,0xd6,0xa1,0x14,0xb0,0x86,0xd2,0xc7,
+  0xde,0xd7,0x6c,0x29,0x0e,0x4c,0xf9,0xb5,0x3e,0x6a,0x30,0xb4,0x9c,0xff,0x87,0x21,
+  0xe1,0xe9,0x90,0xf3,0x31,0x66,0x7c,0x24,0x12,0x4d,0x1c,0x3b,0x38,0x4b,0x45,0xda,
+  0xd7,0x28,0xc4,0x21,0x26,0x71,0xe9,0x53,0x3d,0x85,0x67,0x6a,0x13,0xf5,0x11,0x9d,
+  0x26,0xc2,0xff,0x2f,0x09,0x2c,0x6d,0x12,0xa6,0x29,0xe5,0xcc,0x61,0x8b,0x7f,0x4d,
+  0xc7,0x55,0x85,0xbc,0xa3,0x24,0x05,0x9d,0x30,0x9a,0x0a,0x61,0x4a,0x9a,0x36,0xd1,
+  0x1d,0xe7,0xcb,0x20,0x46,0x93,0xa2,0x4f,0x2e,0x16,0x3c,0xd7,0xe6,0x7c,0xc3,0x72,
+  0x0d,0x29,0xa0,0x61,0x06,0xe5,0xcb,0xf5,0x52,0xb5,0x35,0xd4,0xd4,0xd6,0xad,0x55,
+  0x2c,0x82,0x02,0xc1,0x1a,0xc7,0x70,0x8e,0x96,0xa4,0x05,0x0f,0x59,0xd4,0x39,0x3a,
+  0x27,0x9b,0xa6,0x5a,0xa0,0x2d,0x10,0xd2,0x52,0x01,0x7a,0x27,0xa6,0xda,0x32,0xcd,
+  0x88,0x0b,0xda,0x21,0x1e,0xd0,0xe2,0x34,0x2d,0x16,0xca,0xa3,0x64,0x99,0x20,0x89,
+  0x34,0xfa,0xa6,0xe4,0xad,0x26,0x2f,0xcd,0xe8,0xfb,0x57,0xdf,0x1a,0x4c,0x5f,0xb3,
+  0xc7,0x2c,0x48,0x3e,0x52,0x3d,0x06,0x2d,0x5d,0x27,0xdf,0xb3,0xca,0xb7,0xc5,0xdb,
+  0xd7,0x24,0xc8,0x4f,0x2b,0x81,0x28,0xb8,0x7c,0x97,0xd5,0xd1,0x92,0x85,0x30,0x7b,
+  0xa0,0x24,0x0a,0xf3,0x50,0xfc,0xa2,0xec,0x05,0x33,0x34,0xad,0xc2,0x21,0xf9,0x0a,
+  0x9e,0x9d,0x71,0x16,0x09,0x75,0x8f,0x68,0x6c,0xd2,0xd0,0x2d,0x51,0xb9,0x62,0xda,
+  0x75,0x90,0xc3,0x0d,0x8a,0x5e,0x74,0x0f,0x62,0xac,0xea,0x1c,0xbd,0xdf,0x5b,0x81,
+  0x14,0xa0,0x57,0x36,0x16,0x9c,0xa5,0xdd,0x61,0x59,0x84,0x67,0x3a,0x9b,0xb5,0x8e,
+  0xc8,0x19,0xc1,0x17,0x3c,0x1f,0x71,0x44,0x98,0xe8,0x4a,0x0d,0x4e,0x14,0x11,0xa9,
+  0x97,0x6a,0x61,0xb0,0x12,0x60,0x58,0xa3,0xbb,0xe4,0x2a,0xfa,0xf2,0x86,0x8c,0x89,
+  0xff,0xb0,0x2c,0xa5,0x4d,0x92,0x8a,0xa4,0x7c,0x54,0x9a,0xb6,0x73,0xb4,0x53,0x16,
+  0x6b,0x66,0x46,0x9b,0x58,0x54,0x41,0x1c,0xac,0x56,0x31,0x29,0x78,0x1a,0xf3,0xf0,
+  0x13,0xf5,0x49,0x68,0x87,0xa5,0x85,0xbb,0xc8,0x6a,0xfa,0x43,0x7d,0x14,0xfd,0x15,
+  0xdf,0xfb,0x3d,0xfa,0x1f,0xd3,0xd9,0x2f,0xc1,0xff,0x2b,0x00,0x00,
+  };
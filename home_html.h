@@ -0,0 +1,5 @@
+extern char home_etag[];
+extern const char home_html[];
+extern char home_gz_etag[];
+extern const unsigned int home_gz_len;
+extern const unsigned char home_gz[];
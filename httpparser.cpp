@@ -0,0 +1,416 @@
+/* Licensed under GNU General Public License v3.0
+  See https://github.com/jeffasuk/thermostat
+  jeff at jamcupboard.co.uk
+*/
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "httpparser.h"
+
+enum {P_STATUS, P_HEADERS, P_BODY, P_DONE, P_ERROR};
+enum {CHUNK_SIZE_FIRST, CHUNK_SIZE, CHUNK_EXTENSION, CHUNK_DATA, CHUNK_DATA_END, CHUNK_TRAILER};
+
+void httpParserInit(HTTP_PARSER *parser, HTTP_HEADER_FN on_header, HTTP_BODY_LINE_FN on_body_line, void *arg)
+{
+    memset(parser, 0, sizeof *parser);
+    parser->on_header = on_header;
+    parser->on_body_line = on_body_line;
+    parser->arg = arg;
+    httpParserStart(parser);
+}
+
+void httpParserStart(HTTP_PARSER *parser)
+{
+    parser->state = P_STATUS;
+    parser->chunked = 0;
+    parser->http11 = 0;
+    parser->close = 0;
+    parser->status = 0;
+    parser->content_length = -1;
+    parser->received_length = 0;
+    parser->line_len = 0;
+    parser->line_overflow = 0;
+}
+
+uint8_t httpParserInBody(HTTP_PARSER *parser)
+{
+    return parser->state == P_BODY;
+}
+
+// Remove any CR from the end of the line and add a NUL, if it's not already overflowed
+static void terminateLine(HTTP_PARSER *parser)
+{
+    if (parser->line_len > 0 && parser->line[parser->line_len-1] == '\r')
+    {
+        --parser->line_len;
+    }
+    if (parser->line_len >= HTTP_LINE_SIZE)
+    {
+        parser->line_overflow = 1;  // no room for the NUL
+    }
+    else if (!parser->line_overflow)
+    {
+        parser->line[parser->line_len] = '\0';
+    }
+}
+
+/* Copy bytes up to the next line end into the line buffer, unless the line has already overflowed.
+   Returns a pointer past the bytes used. *complete is set if that includes the end of the line,
+   in which case the line is NUL-terminated, without its CR LF.
+*/
+static const char *takeLine(HTTP_PARSER *parser, const char *data, const char *end, uint8_t *complete)
+{
+    const char *nl = (const char*)memchr(data, '\n', end - data);
+    const char *stop = nl ? nl : end;
+    size_t n = stop - data;
+    if (!parser->line_overflow)
+    {
+        if (parser->line_len + n <= HTTP_LINE_SIZE)
+        {
+            memcpy(parser->line + parser->line_len, data, n);
+            parser->line_len += n;
+        }
+        else
+        {
+            parser->line_overflow = 1;
+        }
+    }
+    *complete = nl != 0;
+    if (!nl)
+    {
+        return end;
+    }
+    terminateLine(parser);
+    return nl + 1;
+}
+
+static void nextLine(HTTP_PARSER *parser)
+{
+    parser->line_len = 0;
+    parser->line_overflow = 0;
+}
+
+// "HTTP/1.x nnn reason". Returns 0 if it isn't a status line.
+static int parseStatusLine(HTTP_PARSER *parser, char *line)
+{
+    if (strncmp(line, "HTTP/1.", 7) || !isdigit((unsigned char)line[7]) || line[8] != ' '
+        || !isdigit((unsigned char)line[9]) || !isdigit((unsigned char)line[10]) || !isdigit((unsigned char)line[11])
+        || (line[12] != ' ' && line[12] != '\0'))
+    {
+        return 0;
+    }
+    parser->http11 = line[7] != '0';
+    parser->close = !parser->http11;    // 1.0 server, which will close anyway
+    parser->status = (line[9] - '0') * 100 + (line[10] - '0') * 10 + (line[11] - '0');
+    return 1;
+}
+
+// Returns 0 if the header makes the response unusable
+static int handleHeaderLine(HTTP_PARSER *parser, char *line)
+{
+    char *value, *value_end;
+    // NB. Does not handle continuation lines
+    if ( (value = strchr(line, ':')) == 0)
+    {
+        return 1;   // not a header. Ignore it.
+    }
+    *(value++) = '\0';
+    while (*value == ' ' || *value == '\t')
+    {
+        value++;
+    }
+    value_end = value + strlen(value);
+    while (value_end > value && (value_end[-1] == ' ' || value_end[-1] == '\t'))
+    {
+        *(--value_end) = '\0';
+    }
+    if (!strcasecmp(line, "Content-Length"))
+    {
+        char *digits_end;
+        long length = strtol(value, &digits_end, 10);
+        if (digits_end == value || *digits_end || length < 0 || length > 0x7fffffffL)
+        {
+            return 0;
+        }
+        parser->content_length = length;
+    }
+    else if (!strcasecmp(line, "Transfer-Encoding"))
+    {
+        parser->chunked = strstr(value, "chunked") != 0;
+    }
+    else if (!strcasecmp(line, "Connection"))
+    {
+        if (!strcasecmp(value, "close"))
+        {
+            parser->close = 1;
+        }
+    }
+    if (parser->on_header)
+    {
+        parser->on_header(parser->arg, line, value);
+    }
+    return 1;
+}
+
+// After the blank line at the end of the headers
+static enum HTTP_PARSE_RESULT endOfHeaders(HTTP_PARSER *parser)
+{
+    if (parser->status < 200)
+    {
+        // interim response (e.g. 100 Continue). The real one follows.
+        httpParserStart(parser);
+        return HTTP_MORE;
+    }
+    if ( (parser->content_length == 0 && !parser->chunked)
+        || parser->status == 204 || parser->status == 304)
+    {
+        parser->state = P_DONE;
+        return HTTP_DONE;
+    }
+    if (parser->content_length < 0 && !parser->chunked)
+    {
+        parser->close = 1;   // body ends when the server closes the connection
+    }
+    parser->state = P_BODY;
+    parser->chunk_state = CHUNK_SIZE_FIRST;
+    parser->chunk_remaining = 0;
+    return HTTP_MORE;
+}
+
+static void bodyLine(HTTP_PARSER *parser)
+{
+    if (parser->line_overflow)
+    {
+        ++parser->long_lines;
+    }
+    else if (parser->line_len && parser->on_body_line)
+    {
+        parser->on_body_line(parser->arg, parser->line);
+    }
+    nextLine(parser);
+}
+
+// Pass body text to the line handler. Returns a pointer past the bytes used.
+static const char *takeBody(HTTP_PARSER *parser, const char *data, const char *end)
+{
+    while (data < end)
+    {
+        uint8_t complete;
+        data = takeLine(parser, data, end, &complete);
+        if (complete)
+        {
+            bodyLine(parser);
+        }
+    }
+    return end;
+}
+
+// the body has all arrived; deal with a final line that had no line terminator
+static enum HTTP_PARSE_RESULT endOfBody(HTTP_PARSER *parser)
+{
+    if (parser->line_len || parser->line_overflow)
+    {
+        terminateLine(parser);
+        bodyLine(parser);
+    }
+    parser->state = P_DONE;
+    return HTTP_DONE;
+}
+
+// Chunked transfer coding. Returns a pointer past the bytes used, or 0 on a framing error.
+static const char *takeChunked(HTTP_PARSER *parser, const char *data, const char *end)
+{
+    while (data < end && parser->state == P_BODY)
+    {
+        char c = *data;
+        switch (parser->chunk_state)
+        {
+          case CHUNK_SIZE_FIRST:
+          case CHUNK_SIZE:
+            if (isxdigit((unsigned char)c))
+            {
+                if (parser->chunk_remaining > 0x0fffffff)
+                {
+                    return 0;
+                }
+                parser->chunk_remaining = parser->chunk_remaining * 16
+                                        + (isdigit((unsigned char)c) ? c - '0' : (tolower((unsigned char)c) - 'a' + 10));
+                parser->chunk_state = CHUNK_SIZE;
+                ++data;
+                break;
+            }
+            if (parser->chunk_state == CHUNK_SIZE_FIRST)
+            {
+                return 0;
+            }
+            parser->chunk_state = CHUNK_EXTENSION;
+            // fall through
+          case CHUNK_EXTENSION:
+            if (*(data++) == '\n')
+            {
+                if (parser->chunk_remaining == 0)
+                {
+                    // the trailer uses the line buffer, so finish off the body's last line now
+                    endOfBody(parser);
+                    parser->state = P_BODY;
+                    parser->chunk_state = CHUNK_TRAILER;
+                }
+                else
+                {
+                    parser->chunk_state = CHUNK_DATA;
+                }
+            }
+            break;
+          case CHUNK_DATA:
+            {
+                size_t n = end - data;
+                if (n > parser->chunk_remaining)
+                {
+                    n = parser->chunk_remaining;
+                }
+                data = takeBody(parser, data, data + n);
+                parser->received_length += n;
+                if ( (parser->chunk_remaining -= n) == 0)
+                {
+                    parser->chunk_state = CHUNK_DATA_END;
+                }
+            }
+            break;
+          case CHUNK_DATA_END:
+            if (*(data++) == '\n')
+            {
+                parser->chunk_remaining = 0;
+                parser->chunk_state = CHUNK_SIZE_FIRST;
+            }
+            break;
+          case CHUNK_TRAILER:
+            // trailer headers are ignored. An empty line ends the response.
+            {
+                uint8_t complete;
+                data = takeLine(parser, data, end, &complete);
+                if (complete)
+                {
+                    uint8_t empty = parser->line_len == 0 && !parser->line_overflow;
+                    nextLine(parser);
+                    if (empty)
+                    {
+                        parser->state = P_DONE;
+                    }
+                }
+            }
+            break;
+        }
+    }
+    return data;
+}
+
+// Feed incoming data through the parser. Returns HTTP_DONE once the response is complete;
+// anything after that is ignored.
+enum HTTP_PARSE_RESULT httpParserFeed(HTTP_PARSER *parser, const char *data, size_t len)
+{
+    const char *end = data + len;
+    while (data < end)
+    {
+        switch (parser->state)
+        {
+          case P_STATUS:
+          case P_HEADERS:
+            {
+                uint8_t complete;
+                data = takeLine(parser, data, end, &complete);
+                if (!complete)
+                {
+                    break;
+                }
+                if (parser->line_overflow)
+                {
+                    if (parser->state == P_STATUS)
+                    {
+                        parser->state = P_ERROR;
+                        return HTTP_ERROR;
+                    }
+                    ++parser->long_lines;   // a header we couldn't use anyway
+                }
+                else if (parser->state == P_STATUS)
+                {
+                    if (!parseStatusLine(parser, parser->line))
+                    {
+                        parser->state = P_ERROR;
+                        return HTTP_ERROR;
+                    }
+                    parser->state = P_HEADERS;
+                }
+                else if (parser->line_len == 0)
+                {
+                    nextLine(parser);
+                    if (endOfHeaders(parser) == HTTP_DONE)
+                    {
+                        return HTTP_DONE;
+                    }
+                    break;
+                }
+                else if (!handleHeaderLine(parser, parser->line))
+                {
+                    parser->state = P_ERROR;
+                    return HTTP_ERROR;
+                }
+                nextLine(parser);
+            }
+            break;
+          case P_BODY:
+            if (parser->chunked)
+            {
+                if ( (data = takeChunked(parser, data, end)) == 0)
+                {
+                    parser->state = P_ERROR;
+                    return HTTP_ERROR;
+                }
+                if (parser->state == P_DONE)
+                {
+                    return HTTP_DONE;
+                }
+            }
+            else if (parser->content_length >= 0)
+            {
+                size_t n = end - data;
+                if (n > (size_t)(parser->content_length - parser->received_length))
+                {
+                    n = parser->content_length - parser->received_length;
+                }
+                data = takeBody(parser, data, data + n);
+                parser->received_length += n;
+                if (parser->received_length >= (uint32_t)parser->content_length)
+                {
+                    return endOfBody(parser);
+                }
+            }
+            else
+            {
+                parser->received_length += end - data;
+                data = takeBody(parser, data, end);
+            }
+            break;
+          case P_DONE:
+            return HTTP_DONE;
+          case P_ERROR:
+            return HTTP_ERROR;
+        }
+    }
+    return parser->state == P_DONE ? HTTP_DONE : parser->state == P_ERROR ? HTTP_ERROR : HTTP_MORE;
+}
+
+// The connection has closed. That completes a body with no length given; anything else is cut short.
+enum HTTP_PARSE_RESULT httpParserEof(HTTP_PARSER *parser)
+{
+    if (parser->state == P_BODY && !parser->chunked && parser->content_length < 0)
+    {
+        return endOfBody(parser);
+    }
+    if (parser->state != P_DONE)
+    {
+        parser->state = P_ERROR;
+        return HTTP_ERROR;
+    }
+    return HTTP_DONE;
+}
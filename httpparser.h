@@ -0,0 +1,56 @@
+/* Licensed under GNU General Public License v3.0
+  See https://github.com/jeffasuk/thermostat
+  jeff at jamcupboard.co.uk
+*/
+
+#ifndef _HTTPPARSER_H
+#define _HTTPPARSER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Incremental parser for the HTTP responses from the report/settings server.
+   Data is fed in as it arrives, in pieces of any size. Line ends are found with memchr and each line
+   is copied at most once, into the fixed line buffer, so memory use is bounded whatever the server sends.
+   Body bytes that aren't wanted (i.e. the rest of an over-long line) are skipped without copying.
+   Handles the status line, headers, Content-Length, chunked transfer coding, and bodies that end when
+   the server closes the connection.
+   The body is treated as lines of text. A line too long for the buffer is dropped whole, rather than being
+   passed on truncated, since a truncated name=value line could apply a wrong value.
+   No Arduino dependencies, so it can be built on the host (see testing/mkHttpTests).
+*/
+
+#define HTTP_LINE_SIZE  128     // longest header or body line, including the terminating NUL
+
+typedef void (*HTTP_HEADER_FN)(void *arg, char *name, char *value);
+typedef void (*HTTP_BODY_LINE_FN)(void *arg, char *line);
+
+enum HTTP_PARSE_RESULT {HTTP_MORE, HTTP_DONE, HTTP_ERROR};
+
+typedef struct {
+    HTTP_HEADER_FN      on_header;
+    HTTP_BODY_LINE_FN   on_body_line;
+    void                *arg;
+
+    uint8_t     state;
+    uint8_t     chunk_state;
+    uint8_t     chunked;
+    uint8_t     http11;             // server said HTTP/1.1 (so the connection can be kept open)
+    uint8_t     close;              // server will close the connection after this response
+    uint8_t     line_overflow;      // the line being assembled didn't fit, so it's being skipped
+    int         status;             // 0 until the status line has been parsed
+    int32_t     content_length;     // -1 if none given
+    uint32_t    received_length;    // body bytes so far (not counting chunk framing)
+    uint32_t    chunk_remaining;
+    uint32_t    long_lines;         // lines dropped for being too long
+    uint16_t    line_len;
+    char        line[HTTP_LINE_SIZE];
+} HTTP_PARSER;
+
+void httpParserInit(HTTP_PARSER *parser, HTTP_HEADER_FN on_header, HTTP_BODY_LINE_FN on_body_line, void *arg);
+void httpParserStart(HTTP_PARSER *parser);      // before each response
+enum HTTP_PARSE_RESULT httpParserFeed(HTTP_PARSER *parser, const char *data, size_t len);
+enum HTTP_PARSE_RESULT httpParserEof(HTTP_PARSER *parser);   // the connection has closed
+uint8_t httpParserInBody(HTTP_PARSER *parser);
+
+#endif  // _HTTPPARSER_H
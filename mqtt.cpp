@@ -0,0 +1,248 @@
+/* Licensed under GNU General Public License v3.0
+  See https://github.com/jeffasuk/thermostat
+  jeff at jamcupboard.co.uk
+*/
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <AsyncMqttClient.h>
+#include "globals.h"
+#include "mqtt.h"
+#include "persistence.h"
+#include "settingsqueue.h"
+#include "telemetry.h"
+#include "utils.h"
+
+/* MQTT reporting backend, used instead of HTTP when mqtthost is set.
+   One persistent session (fixed client id, clean-session off) is kept open to the broker:
+        thermostat/<ident>/telemetry    samples from the report queue, in the configured telemetry_format.
+                                        Events are published at QoS 1 and stay queued until the broker acks them;
+                                        periodic samples are QoS 0.
+        thermostat/<ident>/settings     subscribed at QoS 1. Payload is name=value pairs, separated by newlines
+                                        or '&', applied just like the body of an HTTP report response.
+                                        The broker holds these while the unit is offline.
+        thermostat/<ident>/online       "1" on connect, "0" (retained will) when the unit drops off.
+*/
+#define MQTT_TOPIC_SIZE         80
+#define MQTT_PAYLOAD_SIZE       512
+#define MQTT_SETTINGS_SIZE      512
+#define MQTT_KEEPALIVE_SEC      30
+#define MQTT_RETRY_MIN_MS       5000
+#define MQTT_RETRY_MAX_MS       60000
+
+static AsyncMqttClient mqtt_client;
+static uint8_t  mqtt_started = 0;
+static uint8_t  mqtt_connecting = 0;
+static uint32_t mqtt_retry_at = 0;
+static uint32_t mqtt_retry_delay = MQTT_RETRY_MIN_MS;
+static uint16_t publish_in_flight = 0;  // packet id awaiting PUBACK
+
+// The client library keeps pointers to these, so they must outlive the connection
+static char *mqtt_host = 0;
+static char *mqtt_ident = 0;
+static char client_id[MQTT_TOPIC_SIZE];
+static char topic_telemetry[MQTT_TOPIC_SIZE];
+static char topic_settings[MQTT_TOPIC_SIZE];
+static char topic_online[MQTT_TOPIC_SIZE];
+
+static char payload[MQTT_PAYLOAD_SIZE];
+static char settings_buf[MQTT_SETTINGS_SIZE];
+
+uint8_t mqttEnabled()
+{
+    return p_mqtt_hostname && *p_mqtt_hostname;
+}
+
+static void applySettings(char *p)
+{
+    char *name, *value_str;
+    while (*p)
+    {
+        name = p;
+        p += strcspn(p, "\n&");
+        if (*p)
+        {
+            *p++ = '\0';
+        }
+        if ( (value_str = strchr(name, '=')) != 0)
+        {
+            *(value_str++) = '\0';
+            if (value_str[0] && value_str[strlen(value_str)-1] == '\r')
+            {
+                value_str[strlen(value_str)-1] = '\0';
+            }
+            DOPRINT(F("MQTT setting "));
+            DOPRINT(name);
+            DOPRINT(F(" = '"));
+            DOPRINT(value_str);
+            DOPRINTLN(F("'"));
+            // applied and saved by loop() (see settingsqueue.cpp), as this runs in the TCP context
+            if (!queueSetting(name, value_str, 0))
+            {
+                DOPRINT(F("Settings queue full. MQTT setting lost: "));
+                DOPRINTLN(name);
+            }
+        }
+    }
+}
+
+static void onMqttConnect(bool session_present)
+{
+    DOPRINT(F("MQTT connected. Session present: "));
+    DOPRINTLN(session_present);
+    mqtt_connecting = 0;
+    mqtt_retry_delay = MQTT_RETRY_MIN_MS;
+    if (!session_present)
+    {
+        mqtt_client.subscribe(topic_settings, 1);
+    }
+    mqtt_client.publish(topic_online, 1, true, "1");
+}
+
+static void onMqttDisconnect(AsyncMqttClientDisconnectReason reason)
+{
+    DOPRINT(F("MQTT disconnected: "));
+    DOPRINTLN((int)reason);
+    mqtt_connecting = 0;
+    if (publish_in_flight)
+    {
+        // Only if it was ours: after stopMqtt(), HTTP may have samples in flight by now
+        publish_in_flight = 0;
+        setSamplesInFlight(0);
+    }
+    mqtt_retry_at = millis() + mqtt_retry_delay;
+    mqtt_retry_delay = min(mqtt_retry_delay * 2, (uint32_t)MQTT_RETRY_MAX_MS);
+}
+
+static void onMqttPublish(uint16_t packet_id)
+{
+    if (publish_in_flight && packet_id == publish_in_flight)
+    {
+        publish_in_flight = 0;
+        dropQueuedSamples(1);
+    }
+}
+
+static void onMqttMessage(char *topic, char *data, AsyncMqttClientMessageProperties properties,
+        size_t len, size_t index, size_t total)
+{
+    if (strcmp(topic, topic_settings) || total >= MQTT_SETTINGS_SIZE)
+    {
+        return;
+    }
+    // long messages arrive in pieces
+    memcpy(settings_buf + index, data, len);
+    if (index + len == total)
+    {
+        settings_buf[total] = '\0';
+        applySettings(settings_buf);
+    }
+}
+
+// (Re)connect, picking up any change of broker or identifier
+static void connectMqtt()
+{
+    const char *ident = (p_identifier && *p_identifier) ? p_identifier : "unnamed";
+    if (!mqtt_started)
+    {
+        mqtt_client.onConnect(onMqttConnect);
+        mqtt_client.onDisconnect(onMqttDisconnect);
+        mqtt_client.onPublish(onMqttPublish);
+        mqtt_client.onMessage(onMqttMessage);
+        mqtt_client.setKeepAlive(MQTT_KEEPALIVE_SEC);
+        mqtt_client.setCleanSession(false);
+        mqtt_started = 1;
+    }
+    strdupWithFree(p_mqtt_hostname, &mqtt_host);
+    strdupWithFree(ident, &mqtt_ident);
+    snprintf(client_id, sizeof client_id, "thermostat-%s", ident);
+    snprintf(topic_telemetry, sizeof topic_telemetry, "thermostat/%s/telemetry", ident);
+    snprintf(topic_settings, sizeof topic_settings, "thermostat/%s/settings", ident);
+    snprintf(topic_online, sizeof topic_online, "thermostat/%s/online", ident);
+    mqtt_client.setClientId(client_id);
+    mqtt_client.setWill(topic_online, 1, true, "0");
+    mqtt_client.setServer(mqtt_host, persistent_data.mqtt_port);
+    DOPRINT(F("MQTT connecting to "));
+    DOPRINTLN(mqtt_host);
+    mqtt_connecting = 1;
+    mqtt_client.connect();
+}
+
+static void publishNextSample()
+{
+    REPORT_SAMPLE *sample;
+    char *end = payload + sizeof payload;
+    char *p;
+    uint8_t qos;
+    uint16_t res;
+    if (publish_in_flight || !nbQueuedSamples())
+    {
+        return;
+    }
+    sample = getQueuedSample(0);
+    p = (persistent_data.telemetry_format == TELEMETRY_BINARY)
+            ? encodeOneSampleBinary(payload, end, sample, millis())
+            : formatSampleQuery(payload, end, sample, millis());
+    if (p == end)
+    {
+        DOPRINTLN(F("MQTT report too long. Dropping it."));
+        dropQueuedSamples(1);
+        return;
+    }
+    qos = (sample->flags & SAMPLE_EVENT) ? 1 : 0;
+    res = mqtt_client.publish(topic_telemetry, qos, false, payload, p - payload);
+    if (!res)
+    {
+        return; // client buffers full. Try again next time round.
+    }
+    if (qos)
+    {
+        publish_in_flight = res;
+        setSamplesInFlight(1);
+    }
+    else
+    {
+        dropQueuedSamples(1);
+    }
+}
+
+// Called from loop(), via serviceReports(), and whenever a sample is queued
+void serviceMqtt()
+{
+    if (WiFi.status() != WL_CONNECTED || mqtt_connecting)
+    {
+        return;
+    }
+    if (mqtt_client.connected())
+    {
+        if (strcmp(mqtt_host, p_mqtt_hostname)
+            || strcmp(mqtt_ident, (p_identifier && *p_identifier) ? p_identifier : "unnamed"))
+        {
+            mqtt_client.disconnect();   // settings changed; reconnect once disconnected
+            return;
+        }
+        publishNextSample();
+        return;
+    }
+    if ((int32_t)(millis() - mqtt_retry_at) >= 0)
+    {
+        connectMqtt();
+    }
+}
+
+// Called instead of serviceMqtt() while MQTT isn't enabled, so that clearing mqtthost ends the session,
+// and with it the settings subscription, rather than leaving it running alongside HTTP
+void stopMqtt()
+{
+    if (!mqtt_connecting && !mqtt_client.connected())
+    {
+        return;
+    }
+    DOPRINTLN(F("MQTT no longer configured. Disconnecting."));
+    mqtt_client.disconnect(true);
+    mqtt_connecting = 0;
+    if (publish_in_flight)
+    {
+        publish_in_flight = 0;
+        setSamplesInFlight(0);  // they go by HTTP now
+    }
+}
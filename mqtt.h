@@ -0,0 +1,13 @@
+/* Licensed under GNU General Public License v3.0
+  See https://github.com/jeffasuk/thermostat
+  jeff at jamcupboard.co.uk
+*/
+
+#ifndef _MQTT_H
+#define _MQTT_H
+
+uint8_t mqttEnabled();
+void serviceMqtt();
+void stopMqtt();
+
+#endif  // _MQTT_H
@@ -5,11 +5,18 @@
 #include <string.h>
 #include <Arduino.h>
 #include <ESP8266WiFi.h>
+#include <ESPAsyncTCP.h>
+#include "eepromutils.h"
 #include "globals.h"
+#include "httpparser.h"
 #include "led.h"
+#include "mqtt.h"
 #include "sensors.h"
+#include "settingsjournal.h"
+#include "settingsqueue.h"
 #include "network.h"
 #include "persistence.h"
+#include "telemetry.h"
 #include "utils.h"
 
 WiFiClient client;
@@ -51,25 +58,88 @@ void startAccessPoint()
 }
 
 
+// "aa:bb:cc:dd:ee:ff" into 6 bytes. 0 if it isn't one.
+static uint8_t parseBssid(const char *text, uint8_t *bssid)
+{
+    int i;
+    char *next;
+    if (!text)
+    {
+        return 0;
+    }
+    for (i = 0; i < 6; ++i)
+    {
+        unsigned long byte = strtoul(text, &next, 16);
+        if (next == text || byte > 0xff || *next != (i < 5 ? ':' : '\0'))
+        {
+            return 0;
+        }
+        bssid[i] = byte;
+        text = next + 1;
+    }
+    return 1;
+}
+
+// A fixed address if ip, gateway and netmask are all set and valid, otherwise DHCP
+static void configureAddress()
+{
+    IPAddress ip, gateway, netmask, dns;
+    if (p_static_ip && ip.fromString(p_static_ip) && p_gateway && gateway.fromString(p_gateway)
+            && p_netmask && netmask.fromString(p_netmask))
+    {
+        if (!p_dns || !dns.fromString(p_dns))
+        {
+            dns = gateway;
+        }
+        WiFi.config(ip, gateway, netmask, dns);
+    }
+    else
+    {
+        WiFi.config(IPAddress(), IPAddress(), IPAddress());     // all zero means DHCP
+    }
+}
+
+// Start joining the network. With use_cache, straight to the access point last used, if it's known.
+// Returns 1 if it was.
+static uint8_t beginWiFi(uint8_t use_cache)
+{
+    char *passclear;
+    uint8_t bssid[6];
+    use_cache = use_cache && persistent_data.wifi_channel && parseBssid(p_bssid, bssid);
+    configureAddress();
+    passclear = unrot(p_passrot);
+    if (use_cache)
+    {
+        WiFi.begin(p_ssid, passclear, persistent_data.wifi_channel, bssid);
+    }
+    else
+    {
+        WiFi.begin(p_ssid, passclear);
+    }
+    memset(passclear, 0, strlen(passclear)); // Don't leave the password lying about in memory.
+    free(passclear);
+    return use_cache;
+}
+
 uint8_t connectWiFi()
 {
     int ret = 0;
-    DOPRINTLN("");
+    DOPRINTLN(F(""));
     if (WiFi.status() == WL_CONNECTED)
     {
-        DOPRINT("Already connected to ");
+        DOPRINT(F("Already connected to "));
         DOPRINTLN(p_ssid);
         return 0;
     }
 
     if (!p_passrot || !*p_passrot)
     {
-        DOPRINT("No password when connecting to ");
+        DOPRINT(F("No password when connecting to "));
         DOPRINTLN(p_ssid);
         return 1;
     }
 
-    DOPRINT("Connecting to ");
+    DOPRINT(F("Connecting to "));
     DOPRINTLN(p_ssid);
 
     WiFi.persistent(0); // Don't save config to flash.
@@ -84,82 +154,211 @@ uint8_t connectWiFi()
     setLEDpulse(1, 100, 0, 400);
     for (int i=0; WiFi.status() != WL_CONNECTED && i < 5; ++i)
     {
-        char *passclear;
         unsigned long end_time;
-        DOPRINT(" attempt ");
+        DOPRINT(F(" attempt "));
         DOPRINTLN(i);
         setLED();
         end_time = millis() + 6000;
-        passclear = unrot(p_passrot);
-        DOPRINTLN(passclear);
-        DOPRINTLN(strlen(passclear));
-        WiFi.begin(p_ssid, passclear);
-        DOPRINTLN("clear passclear");
-        memset(passclear, 0, strlen(passclear)); // Don't leave the password lying about in memory.
-        DOPRINTLN("free passclear");
-        free(passclear);
-        DOPRINTLN("null passclear");
-        passclear = 0;
-        DOPRINTLN("delay 100 awaiting WiFi status");
+        beginWiFi(0);
+        DOPRINTLN(F("delay 100 awaiting WiFi status"));
         delay(100);
-        DOPRINT("WiFi.status() ");
+        DOPRINT(F("WiFi.status() "));
         DOPRINTLN(WiFi.status());
         while ( (millis() < end_time) && WiFi.status() != WL_CONNECTED)
         {
             setLED();
-            DOPRINT(".");
+            DOPRINT(F("."));
             delay(100);
         }
     }
-    DOPRINTLN("");
+    DOPRINTLN(F(""));
     setLEDflashing(0, 0);
     if (WiFi.status() != WL_CONNECTED)
     {
-        DOPRINTLN("");
-        DOPRINTLN("Timed out.");
+        DOPRINTLN(F(""));
+        DOPRINTLN(F("Timed out."));
         return 1;
     }
-    DOPRINT("WiFi connected: IP ");  
+    DOPRINT(F("WiFi connected: IP "));  
     DOPRINTLN(WiFi.localIP());
     return 0;
 }
 
+/* Fast boot (see setup()) doesn't wait for WiFi. startWiFi() starts connecting and returns at once, and
+   serviceWiFi(), called from loop(), follows it up.
+   The access point last connected to is remembered (bssid and wifi_channel) and joined directly, which
+   saves scanning every channel. If that hasn't worked within WIFI_CACHED_ATTEMPT_MS (the access point has
+   been replaced, or has changed channel), an ordinary connection is tried, and so on alternately until
+   one works. After a power cut the router is often slower to start than we are, so the cache isn't
+   dropped just because it didn't work straight away; it's updated whenever we connect somewhere else.
+   With ip, gateway and netmask set, the address is fixed, which saves the DHCP exchange as well.
+*/
+#define WIFI_CACHED_ATTEMPT_MS  3000
+#define WIFI_ATTEMPT_MS         30000   // the SDK keeps scanning by itself during this
+
+static enum {WIFI_IDLE, WIFI_CONNECTING, WIFI_CONNECTED} wifi_state = WIFI_IDLE;
+static uint32_t wifi_attempt_at;
+static uint8_t  wifi_used_cache;
+
+static void startWiFiAttempt(uint8_t use_cache)
+{
+    wifi_used_cache = beginWiFi(use_cache);
+    wifi_attempt_at = millis();
+    wifi_state = WIFI_CONNECTING;
+}
+
+// Keep the access point we're connected to for next time, if it's not the one we had
+static void rememberAccessPoint()
+{
+    char bssid_text[18];
+    uint8_t *bssid = WiFi.BSSID();
+    snprintf(bssid_text, sizeof bssid_text, "%02x:%02x:%02x:%02x:%02x:%02x",
+                bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5]);
+    if (persistent_data.wifi_channel != WiFi.channel() || !p_bssid || strcmp(p_bssid, bssid_text))
+    {
+        DOPRINT(F("Remembering access point "));
+        DOPRINTLN(bssid_text);
+        strdupWithFree(bssid_text, &p_bssid);
+        persistent_data.wifi_channel = WiFi.channel();
+        requestSave();
+    }
+}
+
+void startWiFi()
+{
+    if (!p_passrot || !*p_passrot)
+    {
+        DOPRINT(F("No password when connecting to "));
+        DOPRINTLN(p_ssid);
+        return;
+    }
+    DOPRINT(F("Connecting in the background to "));
+    DOPRINTLN(p_ssid);
+    WiFi.persistent(0); // Don't save config to flash.
+    WiFi.mode(WIFI_STA);
+    startWiFiAttempt(1);
+}
+
+// loop() only
+void serviceWiFi()
+{
+    if (WiFi.status() == WL_CONNECTED)
+    {
+        if (wifi_state != WIFI_CONNECTED)
+        {
+            NOTE_BOOT_TIME(wifi);
+            DOPRINT(F("WiFi connected: IP "));
+            DOPRINTLN(WiFi.localIP());
+            rememberAccessPoint();
+            wifi_state = WIFI_CONNECTED;
+        }
+        return;
+    }
+    if (wifi_state == WIFI_CONNECTED)
+    {
+        // The SDK reconnects by itself, but if it's stuck on a cached access point that has gone,
+        // the timeout below tries without it.
+        DOPRINTLN(F("WiFi connection lost"));
+        wifi_attempt_at = millis();
+        wifi_state = WIFI_CONNECTING;
+    }
+    if (wifi_state == WIFI_CONNECTING
+            && millis() - wifi_attempt_at > (wifi_used_cache ? WIFI_CACHED_ATTEMPT_MS : WIFI_ATTEMPT_MS))
+    {
+        DOPRINTLN(wifi_used_cache ? F("Remembered access point not found. Scanning.")
+                                  : F("WiFi not found. Trying again."));
+        startWiFiAttempt(!wifi_used_cache);
+    }
+}
+
+// Synchronous check that the report server can be reached. Only used from the set-up page,
+// to tell the user whether their settings work; normal reporting goes through the async pipeline below.
 int connectTCP()
 {
 
     if (!p_report_hostname || !*p_report_hostname)
     {
-        DOPRINTLN("Not sending report. No server configured.");
+        DOPRINTLN(F("Not sending report. No server configured."));
         return 1;   // server not configured
     }
-    DOPRINT("connecting to ");
+    DOPRINT(F("connecting to "));
     DOPRINT(p_report_hostname);
-    DOPRINT(":");
+    DOPRINT(F(":"));
     DOPRINTLN(persistent_data.port);
 
     // Use WiFiClient class to create TCP connections
     if (! client.connect(p_report_hostname, persistent_data.port))
     {
-        DOPRINTLN("connection failed");
+        DOPRINTLN(F("connection failed"));
         return 1;
     }
-    DOPRINTLN("TCP connected");
+    DOPRINTLN(F("TCP connected"));
+    client.stop();
     return 0;
 }
 
-static enum {GET_STATUS, GET_HEADERS, GET_BODY, END_OF_RESPONSE} http_response_state;
+/* Reports are sent asynchronously, so that a slow or absent server never holds up loop().
+   sendReport() adds a sample to the store-and-forward buffer (see telemetry.cpp) and returns at once.
+   Queued samples are then sent by a single AsyncClient, driven by its callbacks:
+        IDLE -> CONNECTING -> AWAITING_RESPONSE -> IDLE (connection kept open)
+   A lone sample is sent as the original GET request. When several have built up (e.g. during an outage),
+   as many as fit in the request buffer are sent in one POST, one query string per line.
+   With telemetry_format set to TELEMETRY_BINARY, samples are always POSTed in the compact binary
+   encoding described in telemetry.h.
+   Samples are only removed from the buffer once the server has replied with a 2xx status.
+   serviceReports() is called from loop() to start the next request and to enforce
+   the overall timeout. It never waits for anything.
+
+   The connection is HTTP/1.1 keep-alive, so a report normally costs one request/response on an already
+   open connection, with no DNS lookup or TCP handshake. The server's address is cached for DNS_CACHE_TTL_MS.
+   Each request is built complete in request_buf and handed to the TCP stack in one write.
+
+   The same connection is used to pull settings from cfgpath every cfg_poll_sec seconds (see getSettings()).
+   That's a conditional GET, with If-None-Match set from the stored ETag, so an unchanged configuration
+   costs just a 304 with no body. Fetched settings are queued for loop() to apply and save (see
+   settingsqueue.cpp), not written from the network callback.
+*/
+#define REPORT_REQUEST_SIZE     2048
+#define REQUEST_HEADER_SPACE    256     // POST body is built after this much space, then headers are put in front
+#define REPORT_TIMEOUT_MS       5000
+#define REPORT_RETRY_MIN_MS     2000    // back-off after a failed report, doubling up to the max
+#define REPORT_RETRY_MAX_MS     60000
+#define KEEPALIVE_IDLE_MS       60000   // close our end if the connection hasn't been used for this long
+#define DNS_CACHE_TTL_MS        600000  // lwIP doesn't tell us the real TTL, so re-resolve every 10 minutes
+#define SETTINGS_NEVER_MS       0x7fffffff  // cfg_poll_sec 0: after start-up, only fetch when asked (or every ~25 days)
+
+static char     request_buf[REPORT_REQUEST_SIZE];
+static char     *request_start;
+static int      request_len;
+static int      request_sent;
+static int      request_nb_samples;
+
+static AsyncClient *report_client = 0;
+static enum {REPORT_IDLE, REPORT_CONNECTING, REPORT_AWAITING_RESPONSE} report_state = REPORT_IDLE;
+static uint32_t report_started_at;
+static uint32_t report_retry_at = 0;
+static uint32_t report_retry_delay = 0;
+static uint32_t connection_last_used;
+static uint8_t  request_on_reused_connection;
+static uint32_t roster_version_sent;    // binary format: roster last sent on this connection
+static uint8_t  request_is_settings;    // the request in progress is a settings fetch, not a report
+static uint32_t settings_due_at = 0;    // first fetch as soon as possible after start-up
+
+// DNS cache
+static IPAddress server_ip;
+static uint32_t server_ip_resolved_at;
+static char     *server_ip_hostname = 0;  // the name server_ip belongs to, to spot a change of server
+static uint16_t server_ip_port;
+
+static int response_status;
+static uint8_t settings_lost;   // not all of the fetched settings could be queued
 
-static int content_length = -1;
-static int received_length;
-static uint8_t changed_something;
+// Responses are parsed as data arrives (see httpparser.cpp). Body lines are name=value settings.
+static HTTP_PARSER response_parser;
 
-static void handleHeader(char *name, char *value)
+static void onResponseHeader(void *arg, char *name, char *value)
 {
-    if (!strcmp(name, "Content-Length"))
-    {
-        content_length = atoi(value);
-    }
-    else if (!strcmp(name, "ETag"))
+    if (!strcasecmp(name, "ETag"))
     {
         strdupWithFree(value, &new_etag);
     }
@@ -168,221 +367,601 @@ static void handleHeader(char *name, char *value)
     Serial.print(name);
     Serial.print("' : '");
     Serial.print(value);
-    DOPRINTLN("'");
+    DOPRINTLN(F("'"));
 #endif
 }
 
-// returns 0 at end-of-response, 1 otherwise
-static int processLine(char *buf, int term_len)
+static void onResponseBodyLine(void *arg, char *line)
 {
-    switch(http_response_state)
+    char *value_str;
+    if ( (value_str = strchr(line, '=')) == 0)
     {
-      case GET_STATUS:
-        {
-            char *proto, *stat, *comment;
-            proto = buf;
-            stat = strchr(buf, ' ');
-            *(stat++) = '\0';
-            comment = strchr(stat, ' ');
-            *(comment++) = '\0';
-            http_response_state = GET_HEADERS;
-            content_length = -1;
-        }
-        break;
-      case GET_HEADERS:
-        // NB. Does not handle continuation lines
-        if (*buf == '\0')
-        {
-#ifdef COMMS_VERBOSE
-            Serial.println("End of headers");
-#endif
-            if (content_length == 0)
-            {
-#ifdef COMMS_VERBOSE
-                Serial.println("End of empty response");
+        return;
+    }
+    *(value_str++) = '\0';
+#ifndef QUIET
+    Serial.print(line);
+    Serial.print(" = '");
+    Serial.print(value_str);
+    Serial.println("'");
 #endif
-                return 0;
-            }
-            http_response_state = GET_BODY;
-            received_length = 0;
-            changed_something = 0;
-        }
-        else
+    // applied by loop() (see settingsqueue.cpp), as this runs in the TCP context
+    if (!queueSetting(line, value_str, 0))
+    {
+        settings_lost = 1;
+    }
+}
+
+// After a failed request, wait a while before the next one, doubling the wait each time
+static void backOff()
+{
+    report_retry_delay = report_retry_delay ? min(report_retry_delay * 2, (uint32_t)REPORT_RETRY_MAX_MS)
+                                            : REPORT_RETRY_MIN_MS;
+    report_retry_at = millis() + report_retry_delay;
+}
+
+static void scheduleSettingsFetch()
+{
+    settings_due_at = millis() + (persistent_data.cfg_poll_sec ? persistent_data.cfg_poll_sec * 1000
+                                                               : SETTINGS_NEVER_MS);
+}
+
+static void finishSettingsFetch()
+{
+    if (response_status == 200 || response_status == 304)
+    {
+        // Keep the new ETag whether or not anything changed. It only gets saved along with a real change,
+        // so after a restart there may be one unnecessary full fetch.
+        // If some settings couldn't be queued, keep the old one, so the next fetch gets them all again.
+        if (response_status == 200 && (settings_lost || !queueSetting("etag", new_etag, SETTING_NO_SAVE)))
         {
-            char *value;
-            value = strchr(buf, ':');
-            if (value > 0)
-            {
-                *(value++) = '\0';
-                while (*value && *value == ' ')
-                {
-                    value++;
-                }
-                handleHeader(buf, value);
-            }
+            DOPRINTLN(F("Settings queue full. Some fetched settings were lost"));
         }
-        break;
-      case GET_BODY:
-        // each line is name=value
+        scheduleSettingsFetch();
+        report_retry_delay = 0;
+        return;
+    }
+    DOPRINT(F("Settings fetch failed with status "));
+    DOPRINTLN(response_status);
+    if (response_status || !request_on_reused_connection)
+    {
+        // still due, so it goes again once the back-off is over
+        backOff();
+    }
+}
+
+// The request has been dealt with, successfully or not.
+static void finishReport()
+{
+    if (report_state == REPORT_IDLE)
+    {
+        return;
+    }
+    if (report_state == REPORT_AWAITING_RESPONSE)
+    {
+        // If the server closed the connection to mark the end of the body, this finishes it off.
+        // A response that's cut short or garbled counts as no response at all, whatever its status line said.
+        response_status = httpParserEof(&response_parser) == HTTP_ERROR ? 0 : response_parser.status;
+    }
+    if (request_is_settings)
+    {
+        finishSettingsFetch();
+    }
+    else if (response_status >= 200 && response_status < 300)
+    {
+        dropQueuedSamples(request_nb_samples);
+        report_retry_delay = 0;
+    }
+    else if (response_status >= 400 && response_status < 500)
+    {
+        // server doesn't like the request, and won't like it any better next time
+        DOPRINT(F("Report rejected with status "));
+        DOPRINTLN(response_status);
+        dropQueuedSamples(request_nb_samples);
+    }
+    else if (!response_status && request_on_reused_connection)
+    {
+        // Most likely the server closed the idle connection just as we used it. Not worth a back-off;
+        // the next attempt will open a new connection.
+        setSamplesInFlight(0);
+    }
+    else
+    {
+        // keep the samples and try again later
+        setSamplesInFlight(0);
+        backOff();
+    }
+    if (!response_status && report_state == REPORT_CONNECTING)
+    {
+        server_ip_resolved_at = 0;  // maybe the server has moved; look it up again next time
+    }
+    connection_last_used = millis();
+    report_state = REPORT_IDLE;
+}
+
+// Write as much of the request as the TCP stack will take. Normally that's all of it, in one write;
+// if not, the rest goes when earlier data is acked.
+static void sendMoreRequest(AsyncClient *c)
+{
+    while (request_sent < request_len)
+    {
+        size_t nb_written = c->write(request_start + request_sent, request_len - request_sent);
+        if (!nb_written)
         {
-            char *value_str;
-            received_length += strlen(buf) + term_len;
-            if ( (value_str = strchr(buf, '=')) > 0)
-            {
-                *(value_str++) = '\0';
+            break;
+        }
+        request_sent += nb_written;
+    }
+}
+
+static void sendRequest(AsyncClient *c)
+{
+    httpParserStart(&response_parser);
+    settings_lost = 0;
+    report_state = REPORT_AWAITING_RESPONSE;
+    request_sent = 0;
+    sendMoreRequest(c);
+}
+
+static void onReportConnect(void *arg, AsyncClient *c)
+{
+    DOPRINTLN(F("TCP connected"));
+    server_ip = c->remoteIP();
+    if (!server_ip_resolved_at)
+    {
+        server_ip_resolved_at = millis() | 1;   // never zero, which means "not resolved"
+    }
+    sendRequest(c);
+}
+
+static void onReportAck(void *arg, AsyncClient *c, size_t len, uint32_t time)
+{
+    sendMoreRequest(c);
+}
+
+static void onReportData(void *arg, AsyncClient *c, void *data, size_t len)
+{
+    enum HTTP_PARSE_RESULT result;
+    if (report_state != REPORT_AWAITING_RESPONSE
+        || (result = httpParserFeed(&response_parser, (const char*)data, len)) == HTTP_MORE)
+    {
+        return;
+    }
+    finishReport();     // after an HTTP_ERROR, the parser reports it again from httpParserEof()
+    if (result == HTTP_ERROR)
+    {
+        DOPRINTLN(F("Bad response from server"));
+    }
+    if (result == HTTP_ERROR || response_parser.close)
+    {
+        c->close();     // server will close it anyway, or we can't trust what follows
+    }
+}
+
+static void onReportDisconnect(void *arg, AsyncClient *c)
+{
+    finishReport();
+}
+
+static void onReportError(void *arg, AsyncClient *c, int8_t error)
+{
 #ifndef QUIET
-                Serial.print(buf);
-                Serial.print(" = '");
-                Serial.print(value_str);
-                Serial.println("'");
+    Serial.print("Report connection error: ");
+    Serial.println(c->errorToString(error));
 #endif
-                if (setPersistentValue(buf, value_str))
-                {
+    finishReport();
+}
+
+static void onReportTimeout(void *arg, AsyncClient *c, uint32_t time)
+{
+    if (report_state != REPORT_AWAITING_RESPONSE)
+    {
+        return; // idle keep-alive connection; serviceReports() will close it when it's been idle too long
+    }
 #ifndef QUIET
-                    Serial.println("        changed");
+    Serial.println(">>> Client Timeout !");
 #endif
-                    changed_something = 1;
-                    break;
-                }
-            }
-        }
-        if (content_length >= 0 && received_length >= content_length)
+    c->close();
+}
+
+// Put HTTP POST headers in front of the body, which has been built starting at request_buf + REQUEST_HEADER_SPACE
+static void addPostHeaders(const char *content_type, char *body, char *body_end)
+{
+    char header[REQUEST_HEADER_SPACE];
+    int header_len;
+    snprintf(header, sizeof header, "POST %s HTTP/1.1\r\nHost:%s\r\nContent-Type: %s\r\nContent-Length: %d\r\n\r\n",
+                p_report_path ? p_report_path : "/", p_report_hostname, content_type, (int)(body_end - body));
+    header_len = strlen(header);
+    request_start = body - header_len;
+    memcpy(request_start, header, header_len);
+    request_len = body_end - request_start;
+}
+
+static int buildBinaryReportRequest(uint32_t now)
+{
+    char *end = request_buf + REPORT_REQUEST_SIZE;
+    char *samples = request_buf + REQUEST_HEADER_SPACE + TELEMETRY_HEADER_SPACE;
+    char *samples_end;
+    char batch_header[TELEMETRY_HEADER_SPACE];
+    char *batch_header_end;
+    int nb_samples, batch_header_len;
+    // The server keeps the sensor roster for the life of the connection, so it only needs sending
+    // on a new connection or when it has changed.
+    uint8_t with_roster = !report_client || !report_client->connected()
+                            || roster_version_sent != getRosterVersion();
+
+    nb_samples = encodeSamplesBinary(samples, end, &samples_end, now);
+    if (!nb_samples)
+    {
+        return 0;
+    }
+    batch_header_end = encodeBatchHeaderBinary(batch_header, batch_header + sizeof batch_header, nb_samples, with_roster);
+    if (batch_header_end == batch_header + sizeof batch_header)
+    {
+        return 0;
+    }
+    batch_header_len = batch_header_end - batch_header;
+    memcpy(samples - batch_header_len, batch_header, batch_header_len);
+    addPostHeaders("application/x-thermostat-telemetry", samples - batch_header_len, samples_end);
+    if (with_roster)
+    {
+        roster_version_sent = getRosterVersion();
+    }
+    return nb_samples;
+}
+
+// Build a request for as many of the queued samples as will fit. Returns the number of samples included.
+static int buildReportRequest()
+{
+    char *p, *end = request_buf + REPORT_REQUEST_SIZE;
+    char *body;
+    int nb_samples;
+    uint32_t now = millis();
+
+    if (persistent_data.telemetry_format == TELEMETRY_BINARY)
+    {
+        return buildBinaryReportRequest(now);
+    }
+    if (nbQueuedSamples() == 1)
+    {
+        p = request_start = request_buf;
+        p = appendStr(p, end, "GET ");
+        p = appendStr(p, end, p_report_path ? p_report_path : "/");
+        p = appendStr(p, end, "?");
+        p = formatSampleQuery(p, end, getQueuedSample(0), now);
+        p = appendStr(p, end, " HTTP/1.1\r\nHost:");
+        p = appendStr(p, end, p_report_hostname);
+        p = appendStr(p, end, "\r\n\r\n");
+        if (p == end)
         {
-#ifndef QUIET
-            Serial.println("End of response");
-#endif
             return 0;
         }
-        break;
+        request_len = p - request_start;
+        return 1;
+    }
+
+    body = p = request_buf + REQUEST_HEADER_SPACE;
+    for (nb_samples = 0; nb_samples < nbQueuedSamples(); ++nb_samples)
+    {
+        char *line_end = formatSampleQuery(p, end, getQueuedSample(nb_samples), now);
+        line_end = appendStr(line_end, end, "\n");
+        if (line_end == end)
+        {
+            break;  // didn't fit. Leave it for the next request.
+        }
+        p = line_end;
+    }
+    if (!nb_samples)
+    {
+        return 0;
+    }
+    addPostHeaders("text/plain", body, p);
+    return nb_samples;
+}
+
+static uint8_t isServerIpCached()
+{
+    if (!server_ip_resolved_at || (millis() - server_ip_resolved_at) > DNS_CACHE_TTL_MS
+        || !server_ip_hostname || strcmp(server_ip_hostname, p_report_hostname)
+        || server_ip_port != persistent_data.port)
+    {
+        strdupWithFree(p_report_hostname, &server_ip_hostname);
+        server_ip_port = persistent_data.port;
+        server_ip_resolved_at = 0;
+        return 0;
     }
     return 1;
 }
 
-void getResponse()
+// Create the client if need be, and drop a connection whose server details are stale
+static void prepareReportClient()
 {
-    unsigned long timeout;
-    int read_len;
-    int got_so_far;
-    timeout = millis();
-    while (!client.available())
+    if (!report_client)
     {
-        setLED();
-        if ( (millis() - timeout) > 5000)
+        report_client = new AsyncClient();
+        httpParserInit(&response_parser, onResponseHeader, onResponseBodyLine, 0);
+        report_client->onConnect(onReportConnect);
+        report_client->onAck(onReportAck);
+        report_client->onData(onReportData);
+        report_client->onDisconnect(onReportDisconnect);
+        report_client->onError(onReportError);
+        report_client->onTimeout(onReportTimeout);
+        report_client->setRxTimeout(REPORT_TIMEOUT_MS / 1000);
+        report_client->setNoDelay(true);    // each request is one write, so there's nothing to gain by waiting
+    }
+    if (!isServerIpCached() && report_client->connected())
+    {
+        report_client->close(true);     // server details have changed, or it's time to re-resolve
+    }
+}
+
+// Send the request in request_buf, on the open connection if there is one
+static void startRequest(const char *what)
+{
+    report_started_at = millis();
+    response_status = 0;
+    if (report_client->connected())
+    {
+        DOPRINT(F("reusing connection to send "));
+        DOPRINTLN(what);
+        request_on_reused_connection = 1;
+        sendRequest(report_client);
+        return;
+    }
+    DOPRINT(F("connecting to "));
+    DOPRINT(p_report_hostname);
+    DOPRINT(F(":"));
+    DOPRINT(persistent_data.port);
+    DOPRINT(F(" to send "));
+    DOPRINTLN(what);
+    request_on_reused_connection = 0;   // here, not in onConnect, which a failed connect never reaches
+    report_state = REPORT_CONNECTING;
+    if (! (server_ip_resolved_at ? report_client->connect(server_ip, persistent_data.port)
+                                 : report_client->connect(p_report_hostname, persistent_data.port)))
+    {
+        DOPRINTLN(F("connection failed"));
+        finishReport();
+    }
+}
+
+static void startNextReport()
+{
+    if (mqttEnabled())
+    {
+        serviceMqtt();
+        return;
+    }
+    stopMqtt();
+    if (report_state != REPORT_IDLE || !nbQueuedSamples() || WiFi.status() != WL_CONNECTED
+            || (report_retry_delay && (int32_t)(millis() - report_retry_at) < 0))
+    {
+        return;
+    }
+    if (!p_report_hostname || !*p_report_hostname)
+    {
+        DOPRINTLN(F("Not sending report. No server configured."));
+        dropQueuedSamples(nbQueuedSamples());
+        return;
+    }
+    // decide on reuse before building the request, as the binary format depends on it
+    prepareReportClient();
+    if ( (request_nb_samples = buildReportRequest()) == 0)
+    {
+        DOPRINTLN(F("Report too long. Dropping it."));
+        dropQueuedSamples(1);
+        return;
+    }
+    setSamplesInFlight(request_nb_samples);
+    request_is_settings = 0;
+    startRequest("report");
+}
+
+// Conditional GET of cfgpath, when it's due. Reports go first; this waits for the connection to be free.
+static void startSettingsFetch()
+{
+    char *p, *end = request_buf + REPORT_REQUEST_SIZE;
+    if (report_state != REPORT_IDLE || !p_cfg_path || !*p_cfg_path || !p_report_hostname || !*p_report_hostname
+            || WiFi.status() != WL_CONNECTED || (int32_t)(millis() - settings_due_at) < 0
+            || (report_retry_delay && (int32_t)(millis() - report_retry_at) < 0))
+    {
+        return;
+    }
+    prepareReportClient();
+    p = request_start = request_buf;
+    p = appendStr(p, end, "GET ");
+    p = appendStr(p, end, p_cfg_path);
+    if (p_identifier && *p_identifier)
+    {
+        p = appendStr(p, end, strchr(p_cfg_path, '?') ? "&ident=" : "?ident=");
+        p = appendStr(p, end, p_identifier);
+    }
+    p = appendStr(p, end, " HTTP/1.1\r\nHost:");
+    p = appendStr(p, end, p_report_hostname);
+    if (p_etag && *p_etag)
+    {
+        p = appendStr(p, end, "\r\nIf-None-Match: ");
+        p = appendStr(p, end, p_etag);
+    }
+    p = appendStr(p, end, "\r\n\r\n");
+    if (p == end)
+    {
+        DOPRINTLN(F("Settings request too long"));
+        scheduleSettingsFetch();    // no point trying again until something changes
+        return;
+    }
+    request_len = p - request_start;
+    request_nb_samples = 0;
+    request_is_settings = 1;
+    strdupWithFree(0, &new_etag);
+    startRequest("settings request");
+}
+
+// Fetch settings from the server as soon as the connection is free, rather than waiting for cfg_poll_sec.
+// Returns 1 if there's nowhere to fetch them from.
+uint8_t getSettings()
+{
+    if (!p_cfg_path || !*p_cfg_path || !p_report_hostname || !*p_report_hostname)
+    {
+        return 1;
+    }
+    settings_due_at = millis();
+    return 0;
+}
+
+/* UDP reporting. If udp_port is set, periodic samples are sent as single datagrams to the report server,
+   fire-and-forget, instead of going through the HTTP queue. Events still use HTTP, so they're never lost.
+   Each datagram starts with a sequence number so the server can spot gaps:
+        query format:   "seq=<n>&" followed by the usual query string
+        binary format:  varint sequence number, followed by a binary batch of one sample, roster included
+   The server may send back "ack=<highest seq received>&lost=<nb missing since last ack>" now and then.
+   If that shows heavy loss, periodic samples go over HTTP for a while instead.
+   UDP needs the server's address to be in the DNS cache (i.e. HTTP has connected at least once),
+   since a lookup here could block.
+*/
+#define UDP_DATAGRAM_SIZE       512
+#define UDP_MAX_LOSS_PERCENT    25
+#define UDP_FALLBACK_MS         600000
+
+static WiFiUDP  udp;
+static uint16_t udp_local_port = 0;
+static uint32_t udp_sequence = 0;
+static uint32_t udp_sent_since_ack = 0;
+static uint32_t udp_fallback_until;
+static uint8_t  udp_fallback = 0;
+
+static uint8_t canReportByUdp()
+{
+    if (!persistent_data.udp_port || !server_ip_resolved_at || WiFi.status() != WL_CONNECTED || mqttEnabled())
+    {
+        return 0;
+    }
+    if (udp_fallback)
+    {
+        if ((int32_t)(millis() - udp_fallback_until) < 0)
         {
-#ifndef QUIET
-            Serial.println(">>> Client Timeout !");
-#endif
-            client.stop();
-            return;
+            return 0;
         }
+        DOPRINTLN(F("Trying UDP reports again"));
+        udp_fallback = 0;
     }
-    http_response_state = GET_STATUS;
-    content_length = 0;
-    got_so_far = 0;
-    while (client.available() && http_response_state != END_OF_RESPONSE)
+    if (udp_local_port != persistent_data.udp_port)
     {
-        char inbuf[80];
-        char *p;
-        setLED();
-        read_len = client.read((uint8_t*)&inbuf[got_so_far], 80 - got_so_far - 1);
-        if (read_len <= 0)
+        if (udp_local_port)
         {
+            udp.stop();
+        }
+        udp_local_port = persistent_data.udp_port;
+        udp.begin(udp_local_port);
+    }
+    return 1;
+}
+
+static void sendUdpSample(REPORT_SAMPLE *sample)
+{
+    char datagram[UDP_DATAGRAM_SIZE];
+    char *p, *end = datagram + sizeof datagram;
+    uint32_t now = millis();
+    ++udp_sequence;
+    if (persistent_data.telemetry_format == TELEMETRY_BINARY)
+    {
+        p = appendVarint(datagram, end, udp_sequence);
+        p = encodeOneSampleBinary(p, end, sample, now);
+    }
+    else
+    {
+        p = appendStr(datagram, end, "seq=");
+        p = appendUint(p, end, udp_sequence);
+        p = appendStr(p, end, "&");
+        p = formatSampleQuery(p, end, sample, now);
+    }
+    if (p == end)
+    {
+        DOPRINTLN(F("UDP report too long"));
+        return;
+    }
+    udp.beginPacket(server_ip, persistent_data.udp_port);
+    udp.write((uint8_t*)datagram, p - datagram);
+    udp.endPacket();
+    ++udp_sent_since_ack;
+}
+
+// Check for an acknowledgement from the server
+static void checkUdpAcks()
+{
+    char ack[64];
+    int len;
+    char *lost_str;
+    if (!udp_local_port || !udp.parsePacket())
+    {
+        return;
+    }
+    len = udp.read(ack, sizeof ack - 1);
+    if (len <= 0)
+    {
+        return;
+    }
+    ack[len] = '\0';
+    if (strncmp(ack, "ack=", 4) || (lost_str = strstr(ack, "&lost=")) == 0)
+    {
+        return;
+    }
+    uint32_t lost = atoi(lost_str + 6);
+    DOPRINT(F("UDP ack "));
+    DOPRINT(ack + 4);
+    DOPRINT(F(" of "));
+    DOPRINT(udp_sent_since_ack);
+    DOPRINTLN(F(" sent"));
+    if (udp_sent_since_ack && lost * 100 > udp_sent_since_ack * UDP_MAX_LOSS_PERCENT)
+    {
+        DOPRINTLN(F("Too many UDP reports lost. Using HTTP for a while."));
+        udp_fallback = 1;
+        udp_fallback_until = millis() + UDP_FALLBACK_MS;
+    }
+    udp_sent_since_ack = 0;
+}
+
+// Called from loop(). Starts any queued report, abandons one that has taken too long,
+// and closes a keep-alive connection that's no longer being used.
+void serviceReports()
+{
+    if (report_state != REPORT_IDLE && (millis() - report_started_at) > REPORT_TIMEOUT_MS)
+    {
 #ifndef QUIET
-            Serial.println("End of reading");
+        Serial.println(">>> Report Timeout !");
 #endif
-            if (inbuf[0])
-            {
-                processLine(inbuf, 0);
-            }
-            break;
-        }
-        got_so_far += read_len;
-        inbuf[got_so_far] = '\0';
-        if ( (p = strchr(inbuf, '\n')) > 0)
-        {
-            // at least one line
-            int extra_data_len;
-            int term_len;
-            while ( (p = strchr(inbuf, '\n')) > 0)
-            {
-                *p = '\0';
-                term_len = 1;
-                if (p > inbuf && *(p-1) == '\r')
-                {
-                    term_len = 2;
-                    *(p-1) = '\0';
-                }
-                if (!processLine(inbuf, term_len))
-                {
-                    return;
-                }
-                ++p;
-                extra_data_len = got_so_far - (p - inbuf );
-                if (extra_data_len <= 0)
-                {
-                    inbuf[0] = '\0';
-                    got_so_far = 0;
-                    break;
-                }
-                // need to move text after the \n to start of buffer
-                memmove(inbuf, p, extra_data_len);
-                inbuf[extra_data_len] = '\0';
-                got_so_far = extra_data_len;
-            }
-        }
+        report_client->close(true);
+        finishReport();     // in case the close didn't call back
     }
-    client.stop();
+    else if (report_state == REPORT_IDLE && report_client && report_client->connected()
+            && (millis() - connection_last_used) > KEEPALIVE_IDLE_MS)
+    {
+        DOPRINTLN(F("Closing idle report connection"));
+        report_client->close(true);
+    }
+    checkUdpAcks();
+    serviceTelemetry();
+    startNextReport();
+    startSettingsFetch();
 }
 
-void sendReport(float current_temperature, int8_t power_state, int8_t main_state,
-        float switch_offset_below, float switch_offset_above,
-        const char *comment, SENSOR_DATA *sensor_data)
+// Send a sample that was taken earlier (e.g. a point chosen by report compression)
+void sendSample(REPORT_SAMPLE *sample)
 {
-    if (!connectTCP())
+    if (!(sample->flags & SAMPLE_EVENT) && canReportByUdp())
     {
-        char *sanitized_txt = (char*)malloc(strlen(comment) + 1);
-        const char *ps;
-        char *pd;
-        for (ps=comment, pd=sanitized_txt; *ps; ++ps, ++pd)
-        {
-            *pd = (*ps == ' ') ? '+' : *ps;
-        }
-        *pd = '\0';
-        client.print("GET ");
-        client.print(p_report_path);
-        client.print("?ident=");
-        client.print(p_identifier);
-        client.print("&des=");
-        client.print(persistent_data.desired_temperature);
-        client.print("&tmp=");
-        client.print(current_temperature);
-        client.print("&below=");
-        client.print(switch_offset_below);
-        client.print("&above=");
-        client.print(switch_offset_above);
-        client.print("&power=");
-        client.print(power_state ? "on" : "off");
-        client.print("&main=");
-        client.print(main_state ? "on" : "off");
-        client.print("&txt=");
-        client.print(sanitized_txt);
-        for (int i = 0; i < MAX_TEMPERATURE_SENSORS; ++i)
-        {
-            if (sensor_data->temperature[i].ok == ONEWIRE_OK)
-            {
-                char buf[20];
-                client.print("&sensor_");
-                client.print(formatAddr(buf, sensor_data->temperature[i].addr));
-                client.print("=");
-                client.print(sensor_data->temperature[i].temperature_c);
-            }
-        }
-        free(sanitized_txt);
-        client.print(" HTTP/1.0\r\n");  // 1.0 because we don't want to bother with 1.1 features like chunked transfer
-        client.print("Host:");          // Send Host header even though it's optional in 1.0, because Nginx insists on it. Sigh...
-        client.print(p_report_hostname);
-        client.print("\r\n\r\n");
-        getResponse();  // includes client.stop()
+        sendUdpSample(sample);
+        return;
     }
-    setLEDflashing(0, 0);
+    queueSample(sample);
+    startNextReport();
+}
+
+void sendReport(float current_temperature, int8_t power_state, int8_t main_state,
+        float switch_offset_below, float switch_offset_above,
+        const char *comment, SENSOR_DATA *sensor_data, uint8_t is_event)
+{
+    REPORT_SAMPLE sample;
+    fillSample(&sample, current_temperature, power_state, main_state, switch_offset_below, switch_offset_above,
+            comment, sensor_data, is_event);
+    sendSample(&sample);
 }
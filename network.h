@@ -7,13 +7,17 @@
 #define _NETWORK_H
 
 #include "sensors.h"
+#include "telemetry.h"
 void startAccessPoint();
 uint8_t connectWiFi();
+void startWiFi();
+void serviceWiFi();
 int connectTCP();
-void getResponse(WiFiClient client);
 void sendReport(float current_temperature, int8_t power_state, int8_t main_state,
         float switch_offset_below, float switch_offset_above,
-        const char *comment, SENSOR_DATA *sensor_data);
+        const char *comment, SENSOR_DATA *sensor_data, uint8_t is_event);
+void sendSample(REPORT_SAMPLE *sample);
+void serviceReports();
 uint8_t getSettings();
 
 #endif
@@ -0,0 +1,98 @@
+/* Licensed under GNU General Public License v3.0
+  See https://github.com/jeffasuk/thermostat
+  jeff at jamcupboard.co.uk
+*/
+#include <Arduino.h>
+#include "pagetemplate.h"
+
+/* There's no state kept between chunks. Each call renders the page from the start, keeping only the
+   bytes from index onwards that fit in buf, as history.cpp does for /history. The pages are a kB or two,
+   so going over the start again costs less than keeping a renderer alive for each response, and there's
+   nothing to clean up if the browser goes away half way through.
+   The values must therefore not change while a page is being sent.
+*/
+typedef struct {
+    uint8_t *buf;
+    size_t  start;      // offset in the page of buf[0]
+    size_t  end;        // offset just beyond the last byte wanted
+    size_t  pos;        // offset of the next byte produced
+} TEMPLATE_CURSOR;
+
+static void putText(TEMPLATE_CURSOR *cursor, const char *s)
+{
+    size_t len = strlen(s);
+    if (cursor->pos + len > cursor->start)
+    {
+        size_t skip = cursor->pos < cursor->start ? cursor->start - cursor->pos : 0;
+        size_t n = len - skip;
+        if (n > cursor->end - (cursor->pos + skip))
+        {
+            n = cursor->end - (cursor->pos + skip);
+        }
+        memcpy(cursor->buf + cursor->pos + skip - cursor->start, s + skip, n);
+    }
+    cursor->pos += len;
+}
+
+// If there's a well-formed %%name%% at p, put the name in name and return its length in the template. Else 0.
+static size_t getPlaceholder(PGM_P p, char *name)
+{
+    size_t len;
+    char c;
+    if (pgm_read_byte(p) != '%' || pgm_read_byte(p + 1) != '%')
+    {
+        return 0;
+    }
+    for (len = 0; len < TEMPLATE_NAME_SIZE - 1; ++len)
+    {
+        c = pgm_read_byte(p + 2 + len);
+        if (c == '%' && pgm_read_byte(p + 3 + len) == '%')
+        {
+            name[len] = 0;
+            return len ? len + 4 : 0;
+        }
+        if (!c || c == ' ' || c == '\n' || c == '"')
+        {
+            break;
+        }
+        name[len] = c;
+    }
+    return 0;
+}
+
+// Copies up to max_len bytes of the page, starting at index, into buf. Returns how many; 0 at the end.
+size_t renderTemplate(PGM_P const *parts, TEMPLATE_VALUE_FN value_fn, void *arg,
+                      uint8_t *buf, size_t max_len, size_t index)
+{
+    TEMPLATE_CURSOR cursor = {buf, index, index + max_len, 0};
+    char name[TEMPLATE_NAME_SIZE];
+    char value_buf[TEMPLATE_VALUE_SIZE];
+    for ( ; *parts && cursor.pos < cursor.end; ++parts)
+    {
+        PGM_P p = *parts;
+        char c;
+        while ( (c = pgm_read_byte(p)) && cursor.pos < cursor.end)
+        {
+            size_t placeholder_len = (c == '%') ? getPlaceholder(p, name) : 0;
+            if (placeholder_len)
+            {
+                const char *value = value_fn(arg, name, value_buf, sizeof value_buf);
+                if (value)
+                {
+                    putText(&cursor, value);
+                }
+                p += placeholder_len;
+            }
+            else
+            {
+                if (cursor.pos >= cursor.start)
+                {
+                    buf[cursor.pos - cursor.start] = c;
+                }
+                ++cursor.pos;
+                ++p;
+            }
+        }
+    }
+    return cursor.pos > cursor.start ? (cursor.pos < cursor.end ? cursor.pos : cursor.end) - cursor.start : 0;
+}
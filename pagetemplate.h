@@ -0,0 +1,25 @@
+/* Licensed under GNU General Public License v3.0
+  See https://github.com/jeffasuk/thermostat
+  jeff at jamcupboard.co.uk
+*/
+
+#ifndef _PAGETEMPLATE_H
+#define _PAGETEMPLATE_H
+
+#include <Arduino.h>
+
+/* Pages made from templates in flash, with %%name%% placeholders, rendered straight into the
+   web server's send buffer a chunk at a time. Nothing is copied into RAM but the chunk itself.
+   The text for each placeholder comes from a callback; it's RAM text, which may be formatted into the
+   small buffer provided. A NULL result leaves the placeholder empty.
+*/
+#define TEMPLATE_NAME_SIZE  16      // longest placeholder name, including the terminating NUL
+#define TEMPLATE_VALUE_SIZE 24      // buffer for formatting a placeholder's value
+
+typedef const char *(*TEMPLATE_VALUE_FN)(void *arg, const char *name, char *buf, size_t len);
+
+// parts is a NULL-terminated list of PROGMEM templates, which make up the page in order
+size_t renderTemplate(PGM_P const *parts, TEMPLATE_VALUE_FN value_fn, void *arg,
+                      uint8_t *buf, size_t max_len, size_t index);
+
+#endif  // _PAGETEMPLATE_H
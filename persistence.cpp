@@ -3,23 +3,225 @@
   jeff at jamcupboard.co.uk
 */
 #include "globals.h"
+#include "utils.h"
 
 
-/* The following macro caters for all the various int types in persistent data.
-    Although using a macro doesn't reduce code size, it does make modifications/bug fixes easier.
+
+/* Names are looked up by perfect hash. The compiler works the tables out from PERSISTENT_NUMBERS and
+   PERSISTENT_STRINGS: it searches for a seed that gives every name a slot of its own. A lookup is then
+   one hash of the name, one read from the table, and one strcmp_P() to make sure it's the right name.
+   There's one table for setting names and one for form field names. Each slot holds a setting index
+   (numbers first, then strings) plus 1, or 0 if the slot is empty.
+*/
+#define NAME_HASH_BITS  7
+#define NAME_HASH_SIZE  (1 << NAME_HASH_BITS)   // comfortably bigger than the number of names
+
+struct NAME_HASH_TABLE {
+    uint32_t seed;
+    uint8_t slot[NAME_HASH_SIZE];
+};
+
+/* The slot for a name: FNV-1a, starting from the seed. Used both at compile time and on names as they arrive.
+   It's the top bits that get well mixed by FNV, so the slot comes from those.
 */
-#define SET_NEW_SIMPLE_VALUE(VAR_TYPE) \
-{ \
-    VAR_TYPE newval; \
-    VAR_TYPE *current_value = (VAR_TYPE*)p_settable->value; \
-    newval = atoi(value_str); \
-    if (*current_value != newval) \
-    { \
-        changed = 1; \
-        *current_value = newval; \
-    } \
+static constexpr uint32_t nameSlot(const char *s, uint32_t seed)
+{
+    uint32_t h = 2166136261u ^ seed;
+    while (*s)
+    {
+        h = (h ^ (uint8_t)*s++) * 16777619u;
+    }
+    return h >> (32 - NAME_HASH_BITS);
 }
 
+static constexpr bool seedFits(const char * const *names, int nb_names, uint32_t seed)
+{
+    bool used[NAME_HASH_SIZE] = {};
+    for (int i = 0; i < nb_names; ++i)
+    {
+        if (names[i])
+        {
+            uint32_t slot = nameSlot(names[i], seed);
+            if (used[slot])
+            {
+                return false;
+            }
+            used[slot] = true;
+        }
+    }
+    return true;
+}
+
+static constexpr bool namesAreUnique(const char * const *names, int nb_names)
+{
+    for (int i = 0; i < nb_names; ++i)
+    {
+        for (int j = 0; names[i] && j < i; ++j)
+        {
+            const char *a = names[i], *b = names[j];
+            while (b && *a && *a == *b)
+            {
+                ++a, ++b;
+            }
+            if (b && *a == *b)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static constexpr NAME_HASH_TABLE makeNameHashTable(const char * const *names, int nb_names)
+{
+    NAME_HASH_TABLE table = {};
+    while (!seedFits(names, nb_names, table.seed))
+    {
+        ++table.seed;
+    }
+    for (int i = 0; i < nb_names; ++i)
+    {
+        if (names[i])
+        {
+            table.slot[nameSlot(names[i], table.seed)] = i + 1;
+        }
+    }
+    return table;
+}
+
+// Only used by the compiler, so these don't end up in RAM
+static constexpr const char *setting_names[] = {
+#define X(CTYPE, NAME, DEFAULT, FIELD, FORM) #NAME,
+    PERSISTENT_NUMBERS(X)
+#undef X
+#define X(NAME, VAR, FIELD, FORM) #NAME,
+    PERSISTENT_STRINGS(X)
+#undef X
+};
+static constexpr const char *field_names[] = {
+#define X(CTYPE, NAME, DEFAULT, FIELD, FORM) (FORM) ? #FIELD : 0,
+    PERSISTENT_NUMBERS(X)
+#undef X
+#define X(NAME, VAR, FIELD, FORM) (FORM) ? #FIELD : 0,
+    PERSISTENT_STRINGS(X)
+#undef X
+};
+#define NB_SETTINGS (NB_PERSISTENT_NUMBERS + NB_PERSISTENT_STRINGS)
+static_assert(NB_SETTINGS < NAME_HASH_SIZE / 2, "too many settings for the name tables: raise NAME_HASH_BITS");
+static_assert(namesAreUnique(setting_names, NB_SETTINGS), "two settings have the same name");
+static_assert(namesAreUnique(field_names, NB_SETTINGS), "two settings have the same form field");
+
+static constexpr NAME_HASH_TABLE setting_hash PROGMEM = makeNameHashTable(setting_names, NB_SETTINGS);
+static constexpr NAME_HASH_TABLE field_hash PROGMEM = makeNameHashTable(field_names, NB_SETTINGS);
+
+// The index of the setting that a name hashes to, or -1. The caller has to check the name.
+static int hashLookup(const NAME_HASH_TABLE *table, uint32_t seed, const char *name)
+{
+    return (int)pgm_read_byte(&table->slot[nameSlot(name, seed)]) - 1;
+}
+
+PERSISTENT_INFO *findPersistent(const char *name)
+{
+    int i = hashLookup(&setting_hash, setting_hash.seed, name);
+    if (i >= 0 && i < NB_PERSISTENT_NUMBERS && !strcmp_P(name, persistents[i].name))
+    {
+        return &persistents[i];
+    }
+    return 0;
+}
+
+PERSISTENT_STRING_INFO *findPersistentString(const char *name)
+{
+    int i = hashLookup(&setting_hash, setting_hash.seed, name) - NB_PERSISTENT_NUMBERS;
+    if (i >= 0 && !strcmp_P(name, persistent_strings[i].name))
+    {
+        return &persistent_strings[i];
+    }
+    return 0;
+}
+
+/* The name of the setting that a field in the given form sets, or NULL if it's not a field of that form.
+*/
+PGM_P findFormSetting(const char *field, uint8_t form)
+{
+    int i = hashLookup(&field_hash, field_hash.seed, field);
+    if (i < 0)
+    {
+        return 0;
+    }
+    if (i < NB_PERSISTENT_NUMBERS)
+    {
+        PERSISTENT_INFO *p_settable = &persistents[i];
+        return p_settable->form == form && !strcmp_P(field, p_settable->field) ? p_settable->name : 0;
+    }
+    PERSISTENT_STRING_INFO *pers_str_ptr = &persistent_strings[i - NB_PERSISTENT_NUMBERS];
+    return pers_str_ptr->form == form && !strcmp_P(field, pers_str_ptr->field) ? pers_str_ptr->name : 0;
+}
+
+/* Parsing and formatting of the numbers, by C type. The per-setting code below is generated from
+   PERSISTENT_NUMBERS, so the compiler picks the right one for each setting from the type of its field.
+*/
+static void parseNumber(const char *s, int8_t *n)   { *n = atoi(s); }
+static void parseNumber(const char *s, int16_t *n)  { *n = atoi(s); }
+static void parseNumber(const char *s, int32_t *n)  { *n = atoi(s); }
+static void parseNumber(const char *s, uint8_t *n)  { *n = atoi(s); }
+static void parseNumber(const char *s, uint16_t *n) { *n = atoi(s); }
+static void parseNumber(const char *s, uint32_t *n) { *n = strtoul(s, 0, 10); }
+static void parseNumber(const char *s, float *n)    { *n = atof(s); }
+
+static char *formatNumber(char *p, char *end, int8_t n)     { return appendInt(p, end, n); }
+static char *formatNumber(char *p, char *end, int16_t n)    { return appendInt(p, end, n); }
+static char *formatNumber(char *p, char *end, int32_t n)    { return appendInt(p, end, n); }
+static char *formatNumber(char *p, char *end, uint8_t n)    { return appendUint(p, end, n); }
+static char *formatNumber(char *p, char *end, uint16_t n)   { return appendUint(p, end, n); }
+static char *formatNumber(char *p, char *end, uint32_t n)   { return appendUint(p, end, n); }
+static char *formatNumber(char *p, char *end, float n)      { return appendFloat(p, end, n); }
+
+// 1 if it changed
+template <typename T> static uint8_t parseInto(T *field, const char *value_str)
+{
+    T new_value;
+    parseNumber(value_str, &new_value);
+    if (*field == new_value)
+    {
+        return 0;
+    }
+    *field = new_value;
+    return 1;
+}
+
+// Index into persistents[] of each number
+enum {
+#define X(CTYPE, NAME, DEFAULT, FIELD, FORM) NUMBER_##NAME,
+    PERSISTENT_NUMBERS(X)
+#undef X
+};
+
+static uint8_t setNumberSetting(int index, const char *value_str)
+{
+    switch (index)
+    {
+#define X(CTYPE, NAME, DEFAULT, FIELD, FORM) \
+      case NUMBER_##NAME: \
+        return parseInto(&persistent_data.NAME, value_str);
+    PERSISTENT_NUMBERS(X)
+#undef X
+    }
+    return 0;
+}
+
+static char *formatNumberSetting(int index, char *p, char *end)
+{
+    switch (index)
+    {
+#define X(CTYPE, NAME, DEFAULT, FIELD, FORM) \
+      case NUMBER_##NAME: \
+        return formatNumber(p, end, persistent_data.NAME);
+    PERSISTENT_NUMBERS(X)
+#undef X
+    }
+    return p;
+}
 
 void strdupWithFree(const char *src, char **dst_p)
 {
@@ -39,81 +241,72 @@ void strdupWithFree(const char *src, char **dst_p)
 
 uint8_t setPersistentValue(const char *name, const char *value_str)
 {
-    uint8_t changed = 0;
     PERSISTENT_INFO *p_settable;
     PERSISTENT_STRING_INFO *pers_str_ptr;
-    for (p_settable = persistents; p_settable->name; ++p_settable)
+    if ((p_settable = findPersistent(name)) != 0)
     {
-        if (!strcmp(name, p_settable->name))
-        {
-            DOPRINT("set ");
-            DOPRINT(name);
-            DOPRINT("=");
-            DOPRINTLN(value_str);
-            switch (p_settable->type)
-            {
-              case PERS_INT8:
-                SET_NEW_SIMPLE_VALUE(int8_t);
-                return changed;
-              case PERS_UINT8:
-                SET_NEW_SIMPLE_VALUE(uint8_t);
-                return changed;
-              case PERS_INT16:
-                SET_NEW_SIMPLE_VALUE(int16_t);
-                return changed;
-              case PERS_UINT16:
-                SET_NEW_SIMPLE_VALUE(uint16_t);
-                return changed;
-              case PERS_INT32:
-                SET_NEW_SIMPLE_VALUE(int32_t);
-                return changed;
-              case PERS_UINT32:
-                SET_NEW_SIMPLE_VALUE(uint32_t);
-                return changed;
-              case PERS_FLOAT:
-                SET_NEW_SIMPLE_VALUE(float);
-                return changed;
-            }
-            return 0;   // found it, but it wasn't a supported type (unlikely!)
-        }
+        DOPRINT(F("set "));
+        DOPRINT(name);
+        DOPRINT(F("="));
+        DOPRINTLN(value_str);
+        return setNumberSetting(p_settable - persistents, value_str);
     }
     // try string values
-    for (pers_str_ptr = persistent_strings; pers_str_ptr->name; ++pers_str_ptr)
+    if ((pers_str_ptr = findPersistentString(name)) != 0)
     {
-        if (!strcmp(name, pers_str_ptr->name))
+        DOPRINT(F("set "));
+        DOPRINT(name);
+        DOPRINT(F("='"));
+        DOPRINT(value_str);
+        DOPRINTLN(F("'"));
+        if (value_str && *value_str)
         {
-            DOPRINT("set ");
-            DOPRINT(name);
-            DOPRINT("='");
-            DOPRINT(value_str);
-            DOPRINTLN("'");
-            if (value_str && *value_str)
+            // we have a new value
+            if (*(pers_str_ptr->value) && **(pers_str_ptr->value))
             {
-                // we have a new value
-                if (*(pers_str_ptr->value) && **(pers_str_ptr->value))
+                // both have values, so compare them
+                if (strcmp(value_str, *(pers_str_ptr->value)))
                 {
-                    // both have values, so compare them
-                    if (strcmp(value_str, *(pers_str_ptr->value)))
-                    {
-                        strdupWithFree(value_str, pers_str_ptr->value);
-                        return 1;
-                    }
-                    // they were the same
-                    return 0;
+                    strdupWithFree(value_str, pers_str_ptr->value);
+                    return 1;
                 }
-                // didn't have an old value
-                strdupWithFree(value_str, pers_str_ptr->value);
-                return 1;
-            }
-            // got a null or empty value
-            if (*(pers_str_ptr->value) && **(pers_str_ptr->value))
-            {
-                // blank out old value
-                free(*(pers_str_ptr->value));
-                *(pers_str_ptr->value) = 0;
-                return 1;
+                // they were the same
+                return 0;
             }
+            // didn't have an old value
+            strdupWithFree(value_str, pers_str_ptr->value);
+            return 1;
         }
+        // got a null or empty value
+        if (*(pers_str_ptr->value) && **(pers_str_ptr->value))
+        {
+            // blank out old value
+            free(*(pers_str_ptr->value));
+            *(pers_str_ptr->value) = 0;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* The current value of a persistent item as text, for filling in pages.
+   String items give their own storage (or "" if unset); numbers are formatted into buf.
+   Returns NULL if there's no item of that name.
+*/
+const char *getPersistentText(const char *name, char *buf, size_t len)
+{
+    PERSISTENT_INFO *p_settable;
+    PERSISTENT_STRING_INFO *pers_str_ptr;
+    char *end;
+    if ((pers_str_ptr = findPersistentString(name)) != 0)
+    {
+        return *(pers_str_ptr->value) ? *(pers_str_ptr->value) : "";
+    }
+    if ((p_settable = findPersistent(name)) == 0)
+    {
+        return 0;
     }
-    return changed; // Almost certainly 0 if we got here.
+    end = formatNumberSetting(p_settable - persistents, buf, buf + len - 1);
+    *end = 0;
+    return buf;
 }
@@ -4,3 +4,7 @@
 */
 extern uint8_t setPersistentValue(const char *name, const char *value_str);
 extern void strdupWithFree(const char *src, char **dst_p);
+extern const char *getPersistentText(const char *name, char *buf, size_t len);
+extern PERSISTENT_INFO *findPersistent(const char *name);
+extern PERSISTENT_STRING_INFO *findPersistentString(const char *name);
+extern PGM_P findFormSetting(const char *field, uint8_t form);
@@ -44,8 +44,8 @@ void readSensors(SENSOR_DATA *result)
         result->temperature[i].ok = ONEWIRE_NO_RESULT;
     }
     ds_start = 1;
-    MYDOPRINTLN("");
-    MYDOPRINT("Read temperature sensors on pin ");
+    MYDOPRINTLN(F(""));
+    MYDOPRINT(F("Read temperature sensors on pin "));
     MYDOPRINTLN(persistent_data.onewire_pin);
     sensors.begin();
     sensors.setResolution(12);
@@ -65,43 +65,43 @@ void readSensors(SENSOR_DATA *result)
         {
             if (sensors.getAddress(foundaddrs[i], i))
             {
-                MYDOPRINT("Found device ");
+                MYDOPRINT(F("Found device "));
                 MYDOPRINT(i);
-                MYDOPRINT(" with address: ");
+                MYDOPRINT(F(" with address: "));
                 showaddr(foundaddrs[i]);
-                MYDOPRINTLN("");
+                MYDOPRINTLN(F(""));
             }
             else
             {
-                MYDOPRINTLN("Bad address");
+                MYDOPRINTLN(F("Bad address"));
             }
         }
     }
 
     MYDOPRINT(millis());
-    MYDOPRINTLN(" getDeviceCount");
+    MYDOPRINTLN(F(" getDeviceCount"));
     result->nb_temperature_sensors = sensors.getDeviceCount();
     MYDOPRINT(millis());
     MYDOPRINTLN(result->nb_temperature_sensors);
     MYDOPRINT(millis());
-    MYDOPRINTLN(" requestTemperatures");
+    MYDOPRINTLN(F(" requestTemperatures"));
     sensors.requestTemperatures();
     for (int i=0; i < result->nb_temperature_sensors; i++)
     {
         TEMPERATURE_DATA *res = &(result->temperature[i]);
         MYDOPRINT(millis());
-        MYDOPRINT("  temp ");
+        MYDOPRINT(F("  temp "));
         MYDOPRINT(i);
-        MYDOPRINT(" ");
+        MYDOPRINT(F(" "));
         showaddr(foundaddrs[i]);
-        MYDOPRINTLN("");
+        MYDOPRINTLN(F(""));
         float temp_c = sensors.getTempC(foundaddrs[i]);
         MYDOPRINT(millis());
-        MYDOPRINT(" ");
+        MYDOPRINT(F(" "));
         MYDOPRINTLN(temp_c);
         if (temp_c == -127.00)
         {
-            MYDOPRINTLN("Failed to read sensor");
+            MYDOPRINTLN(F("Failed to read sensor"));
             continue;
         }
         // else the reading was OK
@@ -111,7 +111,7 @@ void readSensors(SENSOR_DATA *result)
         memcpy(res->addr, foundaddrs[i], sizeof foundaddrs[i]);
     }
     MYDOPRINT(millis());
-    MYDOPRINT(" end get temperatures from ");
+    MYDOPRINT(F(" end get temperatures from "));
     MYDOPRINT(result->nb_temperature_sensors);
-    MYDOPRINTLN(" sensors");
+    MYDOPRINTLN(F(" sensors"));
 }
@@ -0,0 +1,518 @@
+/* Licensed under GNU General Public License v3.0
+  See https://github.com/jeffasuk/thermostat
+  jeff at jamcupboard.co.uk
+*/
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "globals.h"
+#include "utils.h"
+#include "persistence.h"
+#include "eepromutils.h"
+#include "settingsjournal.h"
+
+/* A record is:
+     RECORD_MARK
+     payload length
+     payload: the setting's name, NUL-terminated, its type (a PERSISTENT_DATA_TYPE), then its value
+     CRC32 of all the above, least significant byte first
+   Numbers are stored as their raw bytes, strings with no terminator (so no bytes at all for an unset one).
+   Records written before the type was added have RECORD_MARK_UNTYPED, and are taken to have the type the
+   setting has now.
+   A later record for a setting overrides an earlier one.
+   A compacted journal starts with a record with an empty name, holding SETTINGS_SCHEMA_VERSION as a
+   PERS_UINT16. A journal without one is version 1.
+   Replay stops at the first record that doesn't check out. After a power cut in the middle of a save,
+   that's the one that was being written, so everything before it is recovered. The damaged end is
+   dropped by compacting the journal straight away, so that new records don't get appended after it.
+*/
+#define RECORD_MARK         0xa6
+#define RECORD_MARK_UNTYPED 0xa5
+#define RECORD_OVERHEAD     6       // mark, length, CRC
+#define MAX_PAYLOAD         255
+#define MAX_JOURNAL_STRINGS 16
+
+static uint32_t journal_size;   // bytes of valid records in the journal. 0 if there's no journal yet.
+static uint16_t journal_schema; // SETTINGS_SCHEMA_VERSION of the journal as read
+static const char schema_record_name[] PROGMEM = "";
+
+/* Run in turn on the settings from a journal with an older SETTINGS_SCHEMA_VERSION, once it's been read.
+   migrations[n] takes them from version n to n + 1.
+*/
+// 1 -> 2: fast_boot is on by default, but a unit that was set up before it existed carries on starting
+// up the way it always has until someone turns it on
+static void keepSlowBoot()
+{
+    persistent_data.fast_boot = 0;
+}
+
+typedef void (*SETTINGS_MIGRATION)();
+static const SETTINGS_MIGRATION migrations[] = {
+    0,      // there's no version 0
+    keepSlowBoot,
+};
+static_assert(sizeof migrations / sizeof migrations[0] == SETTINGS_SCHEMA_VERSION, "need a migration to each schema version");
+
+// Records for settings this firmware doesn't have, kept as they were read so compaction can write them back
+struct UNKNOWN_RECORD {
+    struct UNKNOWN_RECORD *next;
+    uint8_t record[1];  // the whole record, really
+};
+static struct UNKNOWN_RECORD *unknown_records;
+
+// What the journal holds, to tell which settings need a new record: numbers in full, strings by CRC.
+static struct PERSISTENT_DATA journal_data;
+static uint32_t journal_string_crc[MAX_JOURNAL_STRINGS];
+
+static uint8_t valueSize(PERSISTENT_DATA_TYPE type)
+{
+    switch (type)
+    {
+      case PERS_INT8:
+      case PERS_UINT8:
+        return 1;
+      case PERS_INT16:
+      case PERS_UINT16:
+        return 2;
+      case PERS_INT32:
+      case PERS_UINT32:
+        return 4;
+      case PERS_FLOAT:
+        return sizeof(float);
+      default:
+        return 0;
+    }
+}
+
+// The copy in journal_data of a value in persistent_data
+static uint8_t *journalCopy(PERSISTENT_INFO *p_settable)
+{
+    return (uint8_t*)&journal_data + ((uint8_t*)p_settable->value - (uint8_t*)&persistent_data);
+}
+
+static uint32_t stringCrc(const char *s)
+{
+    return s ? crc32Append(0, s, strlen(s)) : 0;
+}
+
+// Everything in the journal now matches the current settings
+static void noteJournalled()
+{
+    PERSISTENT_STRING_INFO *pers_str_ptr;
+    int i;
+    journal_data = persistent_data;
+    for (pers_str_ptr = persistent_strings, i=0; pers_str_ptr->name && i < MAX_JOURNAL_STRINGS; ++pers_str_ptr, ++i)
+    {
+        journal_string_crc[i] = stringCrc(*(pers_str_ptr->value));
+    }
+}
+
+/* Builds a record in buf, which must have room for MAX_PAYLOAD + RECORD_OVERHEAD bytes.
+   Returns its length, or 0 if it's too big to be a record.
+*/
+static int makeRecord(uint8_t *buf, PGM_P name, PERSISTENT_DATA_TYPE type, const void *value, int value_len)
+{
+    int name_len = strlen_P(name) + 1;
+    int payload_len = name_len + 1 + value_len;
+    uint32_t crc;
+    int i;
+    if (payload_len > MAX_PAYLOAD)
+    {
+        DOPRINT(F("Too long to save: "));
+        DOPRINTLN(FPSTR(name));
+        return 0;
+    }
+    buf[0] = RECORD_MARK;
+    buf[1] = payload_len;
+    memcpy_P(buf + 2, name, name_len);
+    buf[2 + name_len] = type;
+    memcpy(buf + 3 + name_len, value, value_len);
+    crc = crc32Append(0, buf, 2 + payload_len);
+    for (i=0; i < 4; ++i)
+    {
+        buf[2 + payload_len + i] = (crc >> (8 * i)) & 0xff;
+    }
+    return payload_len + RECORD_OVERHEAD;
+}
+
+/* Reads the next record into buf. Returns the payload length, or -1 if there isn't a valid record.
+*/
+static int readRecord(File &f, uint8_t *buf)
+{
+    int payload_len;
+    uint32_t crc;
+    int i;
+    if (f.read(buf, 2) != 2 || (buf[0] != RECORD_MARK && buf[0] != RECORD_MARK_UNTYPED))
+    {
+        return -1;
+    }
+    payload_len = buf[1];
+    if (f.read(buf + 2, payload_len + 4) != payload_len + 4)
+    {
+        return -1;
+    }
+    crc = crc32Append(0, buf, 2 + payload_len);
+    for (i=0; i < 4; ++i)
+    {
+        if (buf[2 + payload_len + i] != ((crc >> (8 * i)) & 0xff))
+        {
+            return -1;
+        }
+    }
+    return payload_len;
+}
+
+// Keep a record for a setting this firmware doesn't know, replacing any earlier one for the same name
+static void keepUnknownRecord(const uint8_t *record)
+{
+    struct UNKNOWN_RECORD **pp, *u;
+    int len = record[1] + RECORD_OVERHEAD;
+    for (pp = &unknown_records; *pp; pp = &(*pp)->next)
+    {
+        if (!strcmp((char*)(*pp)->record + 2, (const char*)record + 2))
+        {
+            u = *pp;
+            *pp = u->next;
+            free(u);
+            break;
+        }
+    }
+    if ((u = (struct UNKNOWN_RECORD*)malloc(sizeof *u + len - 1)) != 0)
+    {
+        memcpy(u->record, record, len);
+        u->next = unknown_records;
+        unknown_records = u;
+    }
+}
+
+/* A record whose type isn't the setting's type any more. It goes via text, which setPersistentValue()
+   can turn into any type.
+*/
+static void convertValue(const char *name, uint8_t type, uint8_t *value, int value_len)
+{
+    char text[24];
+    char *end = text + sizeof text - 1;
+    union {
+        int8_t i8; int16_t i16; int32_t i32; uint8_t u8; uint16_t u16; uint32_t u32; float f;
+    } v;
+    if (type == PERS_STR)
+    {
+        value[value_len] = '\0';   // there's room; the CRC follows the payload
+        setPersistentValue(name, (char*)value);
+        return;
+    }
+    if (type > PERS_FLOAT || value_len != valueSize((PERSISTENT_DATA_TYPE)type))
+    {
+        return;
+    }
+    memcpy(&v, value, value_len);
+    switch (type)
+    {
+      case PERS_INT8:
+        end = appendInt(text, end, v.i8);
+        break;
+      case PERS_INT16:
+        end = appendInt(text, end, v.i16);
+        break;
+      case PERS_INT32:
+        end = appendInt(text, end, v.i32);
+        break;
+      case PERS_UINT8:
+        end = appendUint(text, end, v.u8);
+        break;
+      case PERS_UINT16:
+        end = appendUint(text, end, v.u16);
+        break;
+      case PERS_UINT32:
+        end = appendUint(text, end, v.u32);
+        break;
+      case PERS_FLOAT:
+        end = appendFloat(text, end, v.f);
+        break;
+    }
+    *end = '\0';
+    setPersistentValue(name, text);
+}
+
+// Set a value from a record
+static void applyRecord(uint8_t *record)
+{
+    PERSISTENT_INFO *p_settable;
+    PERSISTENT_STRING_INFO *pers_str_ptr;
+    int payload_len = record[1];
+    char *name = (char*)record + 2;
+    int name_len = strnlen(name, payload_len) + 1;
+    uint8_t typed = record[0] == RECORD_MARK;
+    uint8_t *value = record + 2 + name_len + typed;
+    int value_len = payload_len - name_len - typed;
+    uint8_t type = typed ? value[-1] : 0;
+    if (value_len < 0)
+    {
+        return;     // no terminator on the name
+    }
+    if (!*name)
+    {
+        if (value_len == sizeof journal_schema)
+        {
+            memcpy(&journal_schema, value, value_len);
+        }
+        return;
+    }
+    if ((p_settable = findPersistent(name)) != 0)
+    {
+        if ((!typed || type == p_settable->type) && value_len == valueSize(p_settable->type))
+        {
+            memcpy(p_settable->value, value, value_len);
+        }
+        else if (typed)
+        {
+            convertValue(name, type, value, value_len);
+        }
+        return;
+    }
+    if ((pers_str_ptr = findPersistentString(name)) != 0)
+    {
+        if (!typed || type == PERS_STR)
+        {
+            value[value_len] = '\0';    // there's room; the CRC follows the payload
+            strdupWithFree((char*)value, pers_str_ptr->value);
+        }
+        else
+        {
+            convertValue(name, type, value, value_len);
+        }
+        return;
+    }
+    keepUnknownRecord(record);
+}
+
+/* Writes every setting to a new journal, along with the records for settings this firmware doesn't know,
+   and then renames it over the old one, so that a power cut at any point leaves one or the other complete.
+*/
+static void compactJournal()
+{
+    PERSISTENT_INFO *p_settable;
+    PERSISTENT_STRING_INFO *pers_str_ptr;
+    uint8_t record[MAX_PAYLOAD + RECORD_OVERHEAD];
+    struct UNKNOWN_RECORD *u;
+    uint16_t schema = SETTINGS_SCHEMA_VERSION;
+    uint32_t size = 0;
+    uint8_t failed = 0;
+    int len;
+    File f = LittleFS.open(JOURNAL_NEW_FILENAME, "w");
+    if (!f)
+    {
+        DOPRINTLN(F("Can't create settings journal"));
+        return;
+    }
+    len = makeRecord(record, schema_record_name, PERS_UINT16, &schema, sizeof schema);
+    failed = f.write(record, len) != len;
+    size += len;
+    for (p_settable = persistents; p_settable->name && !failed; ++p_settable)
+    {
+        len = makeRecord(record, p_settable->name, p_settable->type, p_settable->value, valueSize(p_settable->type));
+        failed = len && f.write(record, len) != len;
+        size += len;
+    }
+    for (pers_str_ptr = persistent_strings; pers_str_ptr->name && !failed; ++pers_str_ptr)
+    {
+        char *s = *(pers_str_ptr->value);
+        len = makeRecord(record, pers_str_ptr->name, PERS_STR, s ? s : "", s ? strlen(s) : 0);
+        failed = len && f.write(record, len) != len;
+        size += len;
+    }
+    for (u = unknown_records; u && !failed; u = u->next)
+    {
+        len = u->record[1] + RECORD_OVERHEAD;
+        failed = f.write(u->record, len) != len;
+        size += len;
+    }
+    f.close();
+    if (failed || !LittleFS.rename(JOURNAL_NEW_FILENAME, JOURNAL_FILENAME))
+    {
+        DOPRINTLN(F("Failed to write settings journal"));
+        LittleFS.remove(JOURNAL_NEW_FILENAME);
+        return;
+    }
+    DOPRINT(F("Compacted settings journal to "));
+    DOPRINTLN(size);
+    journal_size = size;
+    noteJournalled();
+}
+
+/* Appends a record for each setting that differs from what the journal holds. If the journal would grow
+   past JOURNAL_MAX_SIZE, it's compacted instead, which takes in all the changes.
+*/
+void saveSettings()
+{
+    PERSISTENT_INFO *p_settable;
+    PERSISTENT_STRING_INFO *pers_str_ptr;
+    uint8_t record[MAX_PAYLOAD + RECORD_OVERHEAD];
+    uint8_t failed = 0;
+    int len, i;
+    File f;
+
+    if (!journal_size)
+    {
+        compactJournal();   // nothing there yet, so start with everything
+        return;
+    }
+    f = LittleFS.open(JOURNAL_FILENAME, "a");
+    if (!f)
+    {
+        DOPRINTLN(F("Can't open settings journal"));
+        return;
+    }
+    for (p_settable = persistents; p_settable->name && !failed; ++p_settable)
+    {
+        uint8_t size = valueSize(p_settable->type);
+        if (!memcmp(journalCopy(p_settable), p_settable->value, size)
+                || !(len = makeRecord(record, p_settable->name, p_settable->type, p_settable->value, size)))
+        {
+            continue;
+        }
+        if (journal_size + len > JOURNAL_MAX_SIZE)
+        {
+            f.close();
+            compactJournal();
+            return;
+        }
+        if (!(failed = f.write(record, len) != len))
+        {
+            journal_size += len;
+            memcpy(journalCopy(p_settable), p_settable->value, size);
+        }
+    }
+    for (pers_str_ptr = persistent_strings, i=0; pers_str_ptr->name && i < MAX_JOURNAL_STRINGS && !failed;
+            ++pers_str_ptr, ++i)
+    {
+        char *s = *(pers_str_ptr->value);
+        uint32_t crc = stringCrc(s);
+        if (crc == journal_string_crc[i]
+                || !(len = makeRecord(record, pers_str_ptr->name, PERS_STR, s ? s : "", s ? strlen(s) : 0)))
+        {
+            continue;
+        }
+        if (journal_size + len > JOURNAL_MAX_SIZE)
+        {
+            f.close();
+            compactJournal();
+            return;
+        }
+        if (!(failed = f.write(record, len) != len))
+        {
+            journal_size += len;
+            journal_string_crc[i] = crc;
+        }
+    }
+    f.close();
+    if (failed)
+    {
+        // What was written before the failure is complete; the rest goes next time.
+        DOPRINTLN(F("Failed to write settings journal"));
+    }
+}
+
+uint8_t loadSettings()
+{
+    uint8_t record[MAX_PAYLOAD + RECORD_OVERHEAD];
+    uint32_t file_size = 0;
+    int payload_len;
+    File f;
+
+    LittleFS.begin();
+    if (LittleFS.exists(JOURNAL_NEW_FILENAME))
+    {
+        // A compaction that didn't finish. The old journal is still complete.
+        LittleFS.remove(JOURNAL_NEW_FILENAME);
+    }
+    journal_size = 0;
+    journal_schema = 1;
+    f = LittleFS.open(JOURNAL_FILENAME, "r");
+    if (f)
+    {
+        file_size = f.size();
+        while ((payload_len = readRecord(f, record)) >= 0)
+        {
+            applyRecord(record);
+            journal_size += payload_len + RECORD_OVERHEAD;
+        }
+        f.close();
+    }
+    if (journal_size)
+    {
+        DOPRINT(F("Read settings journal: "));
+        DOPRINTLN(journal_size);
+        noteJournalled();
+        if (journal_schema > SETTINGS_SCHEMA_VERSION)
+        {
+            DOPRINT(F("Settings journal is from newer firmware, schema "));
+            DOPRINTLN(journal_schema);
+        }
+        if (journal_schema < SETTINGS_SCHEMA_VERSION)
+        {
+            DOPRINT(F("Migrating settings from schema "));
+            DOPRINTLN(journal_schema);
+            for (; journal_schema < SETTINGS_SCHEMA_VERSION; ++journal_schema)
+            {
+                migrations[journal_schema]();
+            }
+            compactJournal();
+        }
+        else if (journal_size < file_size)
+        {
+            DOPRINTLN(F("Dropping damaged end of settings journal"));
+            compactJournal();
+        }
+        return 1;
+    }
+    if (!eepromIsUninitialized())
+    {
+        DOPRINTLN(F("Moving settings from EEPROM to journal"));
+        readFromEeprom();
+        keepSlowBoot();     // as for an old journal
+        compactJournal();
+        return 1;
+    }
+    return 0;
+}
+
+/* requestSave() is also called from the setup page handler, in the async context. loop() is only calling
+   serviceSave() then, and the worst that a clash can do is put the save back by a tick.
+*/
+static volatile uint8_t save_pending;
+static volatile uint32_t first_request_ms, last_request_ms;
+static volatile uint8_t save_now;
+
+void requestSave()
+{
+    last_request_ms = millis();
+    if (!save_pending)
+    {
+        first_request_ms = last_request_ms;
+        __sync_synchronize();
+        save_pending = 1;
+    }
+}
+
+void requestSaveNow()
+{
+    save_now = 1;
+    requestSave();
+}
+
+void serviceSave()
+{
+    uint32_t now = millis();
+    if (!save_pending)
+    {
+        return;
+    }
+    __sync_synchronize();
+    if (save_now
+        || now - last_request_ms >= persistent_data.save_delay_sec * 1000UL
+        || now - first_request_ms >= persistent_data.save_max_wait_sec * 1000UL)
+    {
+        save_pending = save_now = 0;
+        saveSettings();
+    }
+}
@@ -0,0 +1,41 @@
+/* Licensed under GNU General Public License v3.0
+  See https://github.com/jeffasuk/thermostat
+  jeff at jamcupboard.co.uk
+*/
+
+#ifndef _SETTINGSJOURNAL_H
+#define _SETTINGSJOURNAL_H
+
+#include <stdint.h>
+
+/* Settings are kept in a journal file in LittleFS. Each save appends a record for each setting that has
+   changed, so the file only needs rewriting when it reaches JOURNAL_MAX_SIZE. LittleFS spreads its
+   erases over the whole filesystem, so frequent changes don't keep erasing the same sector the way
+   the EEPROM emulation does.
+   The EEPROM is only read now, to bring settings across from older firmware.
+*/
+#define JOURNAL_FILENAME        "/settings.log"
+#define JOURNAL_NEW_FILENAME    "/settings.new"   // compacted journal, until it's renamed over the old one
+#define JOURNAL_MAX_SIZE        4096
+
+/* Each record carries the setting's name and type, so a new setting needs nothing more than its line in
+   PERSISTENT_NUMBERS or PERSISTENT_STRINGS (globals.h): it keeps its default until it's set. A setting whose type has
+   changed is converted. Records for settings this firmware doesn't have (from newer firmware, or ones
+   since dropped) are kept, and written back when the journal is compacted.
+   Anything that can't be done that way, such as renaming a setting or changing its units, needs
+   SETTINGS_SCHEMA_VERSION bumping and a function adding to migrations[] in settingsjournal.cpp.
+*/
+#define SETTINGS_SCHEMA_VERSION 2
+
+uint8_t loadSettings();     // 0 if there are no valid settings
+void saveSettings();
+
+/* Changes usually come in bursts: someone stepping the set point, or a script setting one thing per
+   request. So a change doesn't save straight away. The save happens save_delay_sec after the last
+   change, or save_max_wait_sec after the first if changes keep coming.
+*/
+void requestSave();
+void requestSaveNow();      // at the next loop() tick
+void serviceSave();         // loop() only. Does the save when it's due.
+
+#endif  // _SETTINGSJOURNAL_H
@@ -0,0 +1,104 @@
+/* Licensed under GNU General Public License v3.0
+  See https://github.com/jeffasuk/thermostat
+  jeff at jamcupboard.co.uk
+*/
+#include "globals.h"
+#include "settingsjournal.h"
+#include "persistence.h"
+#include "settingsqueue.h"
+
+/* A byte ring with one producer and one consumer, so no lock is needed. All the async handlers run in
+   the one TCP context, so they count as one producer; loop() is the consumer. Only the producer writes
+   queue_head and only the consumer writes queue_tail, each after the bytes it covers have been written
+   or read, with a barrier in between so the other side can never see the index move before the data.
+   Neither side ever waits: a producer that finds no room is told so.
+*/
+static char              queue[SETTINGS_QUEUE_SIZE];
+static volatile uint16_t queue_head = 0;    // next byte to write
+static volatile uint16_t queue_tail = 0;    // next byte to read
+
+#define MAX_NAME_LEN    32
+#define MAX_VALUE_LEN   128
+
+static uint16_t putBytes(uint16_t pos, const char *s, uint16_t len)
+{
+    while (len--)
+    {
+        queue[pos] = *s++;
+        pos = (pos + 1) % SETTINGS_QUEUE_SIZE;
+    }
+    return pos;
+}
+
+uint16_t settingSize(const char *name, const char *value)
+{
+    uint16_t name_len = strlen(name) + 1;
+    uint16_t value_len = (value ? strlen(value) : 0) + 1;
+    if (name_len > MAX_NAME_LEN || value_len > MAX_VALUE_LEN)
+    {
+        return 0;
+    }
+    return 1 + name_len + value_len;
+}
+
+uint16_t settingsQueueRoom()
+{
+    uint16_t used = (queue_head + SETTINGS_QUEUE_SIZE - queue_tail) % SETTINGS_QUEUE_SIZE;
+    return SETTINGS_QUEUE_SIZE - 1 - used;  // one byte always free, so full and empty look different
+}
+
+uint8_t queueSetting(const char *name, const char *value, uint8_t flags)
+{
+    uint16_t size = settingSize(name, value);
+    uint16_t head = queue_head;
+    char flags_byte = flags;
+    if (!size || size > settingsQueueRoom())
+    {
+        return 0;
+    }
+    if (!value)
+    {
+        value = "";
+    }
+    head = putBytes(head, &flags_byte, 1);
+    head = putBytes(head, name, strlen(name) + 1);
+    head = putBytes(head, value, strlen(value) + 1);
+    __sync_synchronize();
+    queue_head = head;
+    return 1;
+}
+
+static uint16_t getString(uint16_t pos, char *buf)
+{
+    while ( (*buf++ = queue[pos]) )
+    {
+        pos = (pos + 1) % SETTINGS_QUEUE_SIZE;
+    }
+    return (pos + 1) % SETTINGS_QUEUE_SIZE;
+}
+
+void applyQueuedSettings()
+{
+    char name[MAX_NAME_LEN];
+    char value[MAX_VALUE_LEN];
+    uint8_t changed_something = 0;
+    uint16_t tail = queue_tail;
+    while (tail != queue_head)
+    {
+        uint8_t flags;
+        __sync_synchronize();   // read the record only after seeing the head that covers it
+        flags = queue[tail];
+        tail = getString((tail + 1) % SETTINGS_QUEUE_SIZE, name);
+        tail = getString(tail, value);
+        __sync_synchronize();
+        queue_tail = tail;
+        if (setPersistentValue(name, value) && !(flags & SETTING_NO_SAVE))
+        {
+            changed_something = 1;
+        }
+    }
+    if (changed_something)
+    {
+        requestSave();
+    }
+}
@@ -0,0 +1,25 @@
+/* Licensed under GNU General Public License v3.0
+  See https://github.com/jeffasuk/thermostat
+  jeff at jamcupboard.co.uk
+*/
+
+#ifndef _SETTINGSQUEUE_H
+#define _SETTINGSQUEUE_H
+
+#include <stdint.h>
+
+/* Setting changes that arrive in the async TCP context (from the web page, and settings fetched from
+   the server) are not applied there, as loop() may be half way through using the values. They are
+   queued as name=value pairs, and loop() applies them at the start of its next tick.
+*/
+#define SETTINGS_QUEUE_SIZE 512     // bytes; a record is a flags byte, then name and value, each NUL-terminated
+#define SETTING_NO_SAVE     0x01    // apply, but not worth a save on its own
+
+uint8_t queueSetting(const char *name, const char *value, uint8_t flags);   // 0 if there's no room
+// For queuing a set of changes all or none: loop() only ever makes more room, so if the sizes of all of
+// them add up to no more than the room, they will all go in.
+uint16_t settingSize(const char *name, const char *value);  // bytes it takes in the queue; 0 if it's too long ever to fit
+uint16_t settingsQueueRoom();
+void applyQueuedSettings();     // loop() only
+
+#endif  // _SETTINGSQUEUE_H
@@ -0,0 +1,167 @@
+/* Licensed under GNU General Public License v3.0
+  See https://github.com/jeffasuk/thermostat
+  jeff at jamcupboard.co.uk
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include "statusformat.h"
+#include "utils.h"
+
+/* Same text, byte for byte, as the String version that came before it, so existing pages and scripts
+   that read /status see no difference. <boot> has been added at the end since.
+*/
+char *formatStatusXml(char *p, char *end, const STATUS_DATA *status)
+{
+    int sensor_index;
+    char addr_buf[17];
+    p = appendStr(p, end, "<status>\n");
+    for (sensor_index = 0; sensor_index < status->nb_sensors; ++sensor_index)
+    {
+        p = appendStr(p, end, " <tmp id=\"");
+        p = appendStr(p, end, formatAddr(addr_buf, (unsigned char*)status->sensor_addr[sensor_index]));
+        p = appendStr(p, end, "\">");
+        p = appendFloat(p, end, status->sensor_temperature[sensor_index]);
+        p = appendStr(p, end, "</tmp>\n");
+    }
+    p = appendStr(p, end, " <state>");
+    p = appendInt(p, end, status->power_state);
+    p = appendStr(p, end, "</state>\n <main>");
+    p = appendInt(p, end, status->main_state);
+    p = appendStr(p, end, "</main>\n <des>");
+    p = appendFloat(p, end, status->desired_temperature);
+    p = appendStr(p, end, "</des>\n <prec>");
+    p = appendFloat(p, end, status->precision);
+    p = appendStr(p, end, "</prec>\n <switchoffsetabove>");
+    p = appendFloat(p, end, status->switch_offset_above);
+    p = appendStr(p, end, "</switchoffsetabove>\n <switchoffsetbelow>");
+    p = appendFloat(p, end, status->switch_offset_below);
+    p = appendStr(p, end, "</switchoffsetbelow>\n <mode>");
+    p = appendStr(p, end, status->heating ? "heating" : "cooling");
+    p = appendStr(p, end, "</mode>\n <runon>");
+    p = appendUint(p, end, status->fan_overrun_sec);
+    p = appendStr(p, end, "</runon>\n <maxrep>");
+    p = appendUint(p, end, status->max_time_between_reports);
+    p = appendStr(p, end, "</maxrep>\n <boot><fast>");
+    p = appendUint(p, end, status->boot.fast);
+    p = appendStr(p, end, "</fast><setup>");
+    p = appendUint(p, end, status->boot.setup);
+    p = appendStr(p, end, "</setup><settings>");
+    p = appendUint(p, end, status->boot.settings);
+    p = appendStr(p, end, "</settings><reading>");
+    p = appendUint(p, end, status->boot.reading);
+    p = appendStr(p, end, "</reading><decision>");
+    p = appendUint(p, end, status->boot.decision);
+    p = appendStr(p, end, "</decision><wifi>");
+    p = appendUint(p, end, status->boot.wifi);
+    return appendStr(p, end, "</wifi></boot>\n</status>\n");
+}
+
+/* The same fields under the same names, for scripts that would rather not parse XML.
+   Given a previous snapshot, only the fields that differ from it are written: that is the delta pushed
+   to /events. The sensors go as a whole array if any of them changed, and the same for the boot times.
+*/
+static char *formatStatusJsonFields(char *p, char *end, const STATUS_DATA *old_status, const STATUS_DATA *status)
+{
+    int sensor_index;
+    char addr_buf[17];
+    const char *sep = "{";
+    if (!old_status || old_status->nb_sensors != status->nb_sensors
+        || memcmp(old_status->sensor_addr, status->sensor_addr, sizeof status->sensor_addr)
+        || memcmp(old_status->sensor_temperature, status->sensor_temperature, sizeof status->sensor_temperature))
+    {
+        p = appendStr(p, end, "{\"tmp\":[");
+        for (sensor_index = 0; sensor_index < status->nb_sensors; ++sensor_index)
+        {
+            p = appendStr(p, end, sensor_index ? ",{\"id\":\"" : "{\"id\":\"");
+            p = appendStr(p, end, formatAddr(addr_buf, (unsigned char*)status->sensor_addr[sensor_index]));
+            p = appendStr(p, end, "\",\"t\":");
+            p = appendFloat(p, end, status->sensor_temperature[sensor_index]);
+            p = appendStr(p, end, "}");
+        }
+        p = appendStr(p, end, "]");
+        sep = ",";
+    }
+#define CHANGED(field)  (!old_status || old_status->field != status->field)
+#define NAME(name)      (p = appendStr(p, end, sep), sep = ",", p = appendStr(p, end, "\"" name "\":"))
+    if (CHANGED(power_state))
+    {
+        NAME("state");
+        p = appendInt(p, end, status->power_state);
+    }
+    if (CHANGED(main_state))
+    {
+        NAME("main");
+        p = appendInt(p, end, status->main_state);
+    }
+    if (CHANGED(desired_temperature))
+    {
+        NAME("des");
+        p = appendFloat(p, end, status->desired_temperature);
+    }
+    if (CHANGED(precision))
+    {
+        NAME("prec");
+        p = appendFloat(p, end, status->precision);
+    }
+    if (CHANGED(switch_offset_above))
+    {
+        NAME("switchoffsetabove");
+        p = appendFloat(p, end, status->switch_offset_above);
+    }
+    if (CHANGED(switch_offset_below))
+    {
+        NAME("switchoffsetbelow");
+        p = appendFloat(p, end, status->switch_offset_below);
+    }
+    if (CHANGED(heating))
+    {
+        NAME("mode");
+        p = appendStr(p, end, status->heating ? "\"heating\"" : "\"cooling\"");
+    }
+    if (CHANGED(fan_overrun_sec))
+    {
+        NAME("runon");
+        p = appendUint(p, end, status->fan_overrun_sec);
+    }
+    if (CHANGED(max_time_between_reports))
+    {
+        NAME("maxrep");
+        p = appendUint(p, end, status->max_time_between_reports);
+    }
+    if (!old_status || memcmp(&old_status->boot, &status->boot, sizeof status->boot))
+    {
+        NAME("boot");
+        p = appendStr(p, end, "{\"fast\":");
+        p = appendUint(p, end, status->boot.fast);
+        p = appendStr(p, end, ",\"setup\":");
+        p = appendUint(p, end, status->boot.setup);
+        p = appendStr(p, end, ",\"settings\":");
+        p = appendUint(p, end, status->boot.settings);
+        p = appendStr(p, end, ",\"reading\":");
+        p = appendUint(p, end, status->boot.reading);
+        p = appendStr(p, end, ",\"decision\":");
+        p = appendUint(p, end, status->boot.decision);
+        p = appendStr(p, end, ",\"wifi\":");
+        p = appendUint(p, end, status->boot.wifi);
+        p = appendStr(p, end, "}");
+    }
+#undef CHANGED
+#undef NAME
+    if (*sep == '{')
+    {
+        p = appendStr(p, end, sep);     // nothing changed
+    }
+    return appendStr(p, end, "}");
+}
+
+char *formatStatusJson(char *p, char *end, const STATUS_DATA *status)
+{
+    p = formatStatusJsonFields(p, end, 0, status);
+    return appendStr(p, end, "\n");
+}
+
+char *formatStatusDeltaJson(char *p, char *end, const STATUS_DATA *old_status, const STATUS_DATA *status)
+{
+    return formatStatusJsonFields(p, end, old_status, status);
+}
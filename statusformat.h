@@ -0,0 +1,52 @@
+/* Licensed under GNU General Public License v3.0
+  See https://github.com/jeffasuk/thermostat
+  jeff at jamcupboard.co.uk
+*/
+
+#ifndef _STATUSFORMAT_H
+#define _STATUSFORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Rendering of the /status document, as XML and as JSON, straight into a caller's buffer.
+   No String, no heap, no sprintf: just the append* helpers from utils.cpp.
+   Works from a plain snapshot of the values, so publishStatus() can tell whether anything changed
+   with one memcmp, and so it can be built and benchmarked on the host (see testing/statusbench.cpp).
+*/
+
+#define STATUS_MAX_SENSORS  8
+
+// ms since reset when start-up reached each stage, 0 if it hasn't yet. See BOOT_TIMES in globals.h.
+typedef struct {
+    uint32_t    setup;
+    uint32_t    settings;
+    uint32_t    reading;
+    uint32_t    decision;
+    uint32_t    wifi;
+    uint8_t     fast;               // fast_boot
+} STATUS_BOOT;
+
+typedef struct {
+    uint8_t     nb_sensors;
+    uint8_t     sensor_addr[STATUS_MAX_SENSORS][8];
+    float       sensor_temperature[STATUS_MAX_SENSORS];
+    int8_t      power_state;
+    int8_t      main_state;
+    uint8_t     heating;            // mode == HEATING
+    float       desired_temperature;
+    float       precision;
+    float       switch_offset_above;
+    float       switch_offset_below;
+    uint32_t    fan_overrun_sec;
+    uint32_t    max_time_between_reports;
+    STATUS_BOOT boot;
+} STATUS_DATA;
+
+// Each returns the new end of the text, as the append* functions do; == end means the buffer was too small.
+char *formatStatusXml(char *p, char *end, const STATUS_DATA *status);
+char *formatStatusJson(char *p, char *end, const STATUS_DATA *status);
+// just the fields that differ between the two, as a JSON object without a trailing newline
+char *formatStatusDeltaJson(char *p, char *end, const STATUS_DATA *old_status, const STATUS_DATA *status);
+
+#endif  // _STATUSFORMAT_H
@@ -0,0 +1,398 @@
+/* Licensed under GNU General Public License v3.0
+  See https://github.com/jeffasuk/thermostat
+  jeff at jamcupboard.co.uk
+*/
+#include <Arduino.h>
+#include "globals.h"
+#include "sensors.h"
+#include "telemetry.h"
+#include "utils.h"
+#ifdef REPORT_SPILL_TO_FLASH    // set in telemetry.h, so it has to come after that
+#include <LittleFS.h>
+#endif
+
+/* Ring buffer of samples waiting to be reported, oldest at queue_head.
+   When full, the oldest periodic sample is discarded (or spilled to flash) to make room, so event samples
+   (safety trips, switching, change of direction) survive an outage in preference to routine ones.
+   The oldest nb_in_flight samples are being sent and must not be discarded.
+*/
+static REPORT_SAMPLE sample_queue[REPORT_QUEUE_LENGTH];
+static uint8_t queue_head = 0;
+static uint8_t queue_count = 0;
+static uint8_t nb_in_flight = 0;
+
+// Sensor addresses are held once here rather than in every sample.
+static unsigned char sensor_roster[SENSOR_ROSTER_SIZE][8];
+static uint8_t nb_roster = 0;
+static uint32_t roster_version = 0;     // changes whenever the roster does
+
+#ifdef REPORT_SPILL_TO_FLASH
+static const char spill_filename[] = "/spill.bin";
+static uint32_t spill_read_pos = 0;
+static uint32_t spill_size = 0;
+#endif
+
+static REPORT_SAMPLE *sampleAt(int index)
+{
+    return &sample_queue[(queue_head + index) % REPORT_QUEUE_LENGTH];
+}
+
+static int isSpillEmpty()
+{
+#ifdef REPORT_SPILL_TO_FLASH
+    return spill_read_pos >= spill_size;
+#else
+    return 1;
+#endif
+}
+
+static int findRosterSlot(unsigned char addr[8])
+{
+    int slot;
+    for (slot = 0; slot < nb_roster; ++slot)
+    {
+        if (!memcmp(sensor_roster[slot], addr, 8))
+        {
+            return slot;
+        }
+    }
+    if (nb_roster == SENSOR_ROSTER_SIZE)
+    {
+        if (queue_count || !isSpillEmpty())
+        {
+            // Roster full of sensors still referenced by queued samples. Can only happen after several sensor changes
+            // during a long outage.
+            return -1;
+        }
+        nb_roster = 0;
+    }
+    ++roster_version;
+    memcpy(sensor_roster[nb_roster], addr, 8);
+    return nb_roster++;
+}
+
+// remove the sample at the given position, closing up the gap
+static void removeSample(int index)
+{
+    for (; index > 0; --index)
+    {
+        *sampleAt(index) = *sampleAt(index - 1);
+    }
+    queue_head = (queue_head + 1) % REPORT_QUEUE_LENGTH;
+    --queue_count;
+}
+
+#ifdef REPORT_SPILL_TO_FLASH
+static void spillSample(REPORT_SAMPLE *sample)
+{
+    File f = LittleFS.open(spill_filename, "a");
+    if (f)
+    {
+        spill_size += f.write((uint8_t*)sample, sizeof *sample);
+        f.close();
+    }
+}
+
+// Bring spilled samples back into RAM as space becomes free. They carry their own timestamps,
+// so it doesn't matter that they arrive after newer samples.
+static void unspillSamples()
+{
+    File f;
+    if (isSpillEmpty() || queue_count >= REPORT_QUEUE_LENGTH / 2)
+    {
+        return;
+    }
+    f = LittleFS.open(spill_filename, "r");
+    if (!f || !f.seek(spill_read_pos))
+    {
+        spill_read_pos = spill_size = 0;
+        return;
+    }
+    while (queue_count < REPORT_QUEUE_LENGTH / 2
+            && f.read((uint8_t*)sampleAt(queue_count), sizeof(REPORT_SAMPLE)) == sizeof(REPORT_SAMPLE))
+    {
+        ++queue_count;
+        spill_read_pos += sizeof(REPORT_SAMPLE);
+    }
+    f.close();
+    if (isSpillEmpty())
+    {
+        LittleFS.remove(spill_filename);
+        spill_read_pos = spill_size = 0;
+    }
+}
+#endif
+
+// make room for one more sample
+static void evictSample()
+{
+    int index;
+    REPORT_SAMPLE *victim;
+    for (index = nb_in_flight; index < queue_count; ++index)
+    {
+        if (!(sampleAt(index)->flags & SAMPLE_EVENT))
+        {
+            break;
+        }
+    }
+    if (index == queue_count)
+    {
+        // nothing but events. Lose the oldest.
+        index = nb_in_flight;
+    }
+    if (index >= queue_count)
+    {
+        return; // everything is in flight; caller will have to drop the new sample
+    }
+    victim = sampleAt(index);
+#ifdef REPORT_SPILL_TO_FLASH
+    spillSample(victim);
+#else
+    DOPRINT(F("Report buffer full. Discarding sample: "));
+    DOPRINTLN(victim->text);
+#endif
+    removeSample(index);
+}
+
+void startTelemetry()
+{
+#ifdef REPORT_SPILL_TO_FLASH
+    // millis() timestamps in any old spill file are meaningless after a restart
+    LittleFS.begin();
+    LittleFS.remove(spill_filename);
+#endif
+}
+
+void fillSample(REPORT_SAMPLE *sample, float current_temperature, int8_t power_state, int8_t main_state,
+        float switch_offset_below, float switch_offset_above,
+        const char *comment, SENSOR_DATA *sensor_data, uint8_t is_event)
+{
+    sample->taken_at = millis();
+    sample->flags = (is_event ? SAMPLE_EVENT : 0)
+                  | (power_state ? SAMPLE_POWER_ON : 0)
+                  | (main_state ? SAMPLE_MAIN_ON : 0);
+    sample->desired_temperature = persistent_data.desired_temperature;
+    sample->temperature = current_temperature;
+    sample->switch_offset_below = switch_offset_below;
+    sample->switch_offset_above = switch_offset_above;
+    strncpy(sample->text, comment, REPORT_TEXT_LENGTH - 1);
+    sample->text[REPORT_TEXT_LENGTH - 1] = '\0';
+    sample->nb_sensors = 0;
+    for (int i = 0; i < MAX_TEMPERATURE_SENSORS; ++i)
+    {
+        if (sensor_data->temperature[i].ok == ONEWIRE_OK)
+        {
+            int slot = findRosterSlot(sensor_data->temperature[i].addr);
+            if (slot >= 0)
+            {
+                sample->sensor_slot[sample->nb_sensors] = slot;
+                sample->sensor_temperature[sample->nb_sensors] = sensor_data->temperature[i].temperature_c;
+                ++sample->nb_sensors;
+            }
+        }
+    }
+}
+
+void queueSample(REPORT_SAMPLE *sample)
+{
+    if (queue_count == REPORT_QUEUE_LENGTH)
+    {
+        evictSample();
+        if (queue_count == REPORT_QUEUE_LENGTH)
+        {
+            DOPRINTLN(F("Report buffer full. Dropping new sample."));
+            return;
+        }
+    }
+    *sampleAt(queue_count) = *sample;
+    ++queue_count;
+}
+
+int nbQueuedSamples()
+{
+    return queue_count;
+}
+
+REPORT_SAMPLE *getQueuedSample(int index)
+{
+    return (index < queue_count) ? sampleAt(index) : 0;
+}
+
+void setSamplesInFlight(int nb)
+{
+    nb_in_flight = nb;
+}
+
+void dropQueuedSamples(int nb)
+{
+    nb_in_flight = 0;
+    while (nb-- && queue_count)
+    {
+        queue_head = (queue_head + 1) % REPORT_QUEUE_LENGTH;
+        --queue_count;
+    }
+}
+
+unsigned char *getRosterAddr(uint8_t slot)
+{
+    return sensor_roster[slot];
+}
+
+// Called from loop()
+void serviceTelemetry()
+{
+#ifdef REPORT_SPILL_TO_FLASH
+    if (!nb_in_flight)
+    {
+        unspillSamples();
+    }
+#endif
+}
+
+// The original report format, as URL query parameters. 'age' tells the server how many seconds ago
+// the sample was taken, and is only sent for samples that have had to wait.
+char *formatSampleQuery(char *p, char *end, REPORT_SAMPLE *sample, uint32_t now)
+{
+    const char *ps;
+    uint32_t age_sec = (now - sample->taken_at) / 1000;
+    p = appendStr(p, end, "ident=");
+    p = appendStr(p, end, p_identifier ? p_identifier : "");
+    p = appendStr(p, end, "&des=");
+    p = appendFloat(p, end, sample->desired_temperature);
+    p = appendStr(p, end, "&tmp=");
+    p = appendFloat(p, end, sample->temperature);
+    p = appendStr(p, end, "&below=");
+    p = appendFloat(p, end, sample->switch_offset_below);
+    p = appendStr(p, end, "&above=");
+    p = appendFloat(p, end, sample->switch_offset_above);
+    p = appendStr(p, end, "&power=");
+    p = appendStr(p, end, (sample->flags & SAMPLE_POWER_ON) ? "on" : "off");
+    p = appendStr(p, end, "&main=");
+    p = appendStr(p, end, (sample->flags & SAMPLE_MAIN_ON) ? "on" : "off");
+    p = appendStr(p, end, "&txt=");
+    for (ps = sample->text; *ps && p < end; ++ps)
+    {
+        *p++ = (*ps == ' ') ? '+' : *ps;
+    }
+    for (int i = 0; i < sample->nb_sensors; ++i)
+    {
+        char buf[20];
+        p = appendStr(p, end, "&sensor_");
+        p = appendStr(p, end, formatAddr(buf, sensor_roster[sample->sensor_slot[i]]));
+        p = appendStr(p, end, "=");
+        p = appendFloat(p, end, sample->sensor_temperature[i]);
+    }
+    if (age_sec)
+    {
+        p = appendStr(p, end, "&age=");
+        p = appendUint(p, end, age_sec);
+    }
+    return p;
+}
+
+uint32_t getRosterVersion()
+{
+    return roster_version;
+}
+
+static char *appendBytes(char *p, char *end, const char *bytes, int len)
+{
+    p = appendVarint(p, end, len);
+    while (len-- && p < end)
+    {
+        *p++ = *bytes++;
+    }
+    return p;
+}
+
+static int32_t toCentiDegrees(float t)
+{
+    return (int32_t)(t * 100 + (t < 0 ? -0.5 : 0.5));
+}
+
+// Encode one sample, as a delta from the previous one (if any). Returns 'end' if it didn't fit.
+static char *encodeSampleBinary(char *p, char *end, REPORT_SAMPLE *sample, REPORT_SAMPLE *previous,
+                int32_t previous_sensor[SENSOR_ROSTER_SIZE], uint32_t now)
+{
+    uint8_t flags = sample->flags;
+    int32_t t;
+    if (!previous
+        || sample->desired_temperature != previous->desired_temperature
+        || sample->switch_offset_below != previous->switch_offset_below
+        || sample->switch_offset_above != previous->switch_offset_above)
+    {
+        flags |= SAMPLE_SETTINGS;
+    }
+    p = appendVarint(p, end, (now - sample->taken_at) / 1000);
+    p = appendByte(p, end, flags);
+    p = appendSvarint(p, end, toCentiDegrees(sample->temperature) - (previous ? toCentiDegrees(previous->temperature) : 0));
+    if (flags & SAMPLE_SETTINGS)
+    {
+        p = appendSvarint(p, end, toCentiDegrees(sample->desired_temperature));
+        p = appendSvarint(p, end, toCentiDegrees(sample->switch_offset_below));
+        p = appendSvarint(p, end, toCentiDegrees(sample->switch_offset_above));
+    }
+    if (flags & SAMPLE_EVENT)
+    {
+        p = appendBytes(p, end, sample->text, strlen(sample->text));
+    }
+    p = appendVarint(p, end, sample->nb_sensors);
+    for (int i = 0; i < sample->nb_sensors; ++i)
+    {
+        uint8_t slot = sample->sensor_slot[i];
+        t = toCentiDegrees(sample->sensor_temperature[i]);
+        p = appendVarint(p, end, slot);
+        p = appendSvarint(p, end, t - previous_sensor[slot]);
+        previous_sensor[slot] = t;
+    }
+    return p;
+}
+
+// Encode as many queued samples as fit between p and end. Returns the number encoded,
+// and sets *encoded_end to the end of the encoded data.
+int encodeSamplesBinary(char *p, char *end, char **encoded_end, uint32_t now)
+{
+    int32_t previous_sensor[SENSOR_ROSTER_SIZE] = {0};
+    REPORT_SAMPLE *previous = 0;
+    int nb;
+    *encoded_end = p;
+    for (nb = 0; nb < queue_count; ++nb)
+    {
+        REPORT_SAMPLE *sample = sampleAt(nb);
+        char *q = encodeSampleBinary(p, end, sample, previous, previous_sensor, now);
+        if (q == end)
+        {
+            break;  // didn't fit. Leave it for the next request.
+        }
+        p = *encoded_end = q;
+        previous = sample;
+    }
+    return nb;
+}
+
+// A complete batch holding just the given sample, roster included
+char *encodeOneSampleBinary(char *p, char *end, REPORT_SAMPLE *sample, uint32_t now)
+{
+    int32_t previous_sensor[SENSOR_ROSTER_SIZE] = {0};
+    p = encodeBatchHeaderBinary(p, end, 1, 1);
+    return encodeSampleBinary(p, end, sample, 0, previous_sensor, now);
+}
+
+char *encodeBatchHeaderBinary(char *p, char *end, int nb_samples, uint8_t with_roster)
+{
+    p = appendByte(p, end, TELEMETRY_BINARY_VERSION);
+    p = appendByte(p, end, with_roster ? BATCH_HAS_ROSTER : 0);
+    p = appendBytes(p, end, p_identifier ? p_identifier : "", p_identifier ? strlen(p_identifier) : 0);
+    if (with_roster)
+    {
+        p = appendVarint(p, end, nb_roster);
+        for (int slot = 0; slot < nb_roster; ++slot)
+        {
+            for (int i = 0; i < 8; ++i)
+            {
+                p = appendByte(p, end, sensor_roster[slot][i]);
+            }
+        }
+    }
+    return appendVarint(p, end, nb_samples);
+}
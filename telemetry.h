@@ -0,0 +1,92 @@
+/* Licensed under GNU General Public License v3.0
+  See https://github.com/jeffasuk/thermostat
+  jeff at jamcupboard.co.uk
+*/
+
+#ifndef _TELEMETRY_H
+#define _TELEMETRY_H
+
+#include "sensors.h"
+
+// Store-and-forward buffer for report samples.
+// Samples are kept until the server has accepted them, so nothing is lost while WiFi or the server is down.
+
+#define REPORT_QUEUE_LENGTH     24  // samples held in RAM
+#define REPORT_TEXT_LENGTH      80  // report comment, truncated to fit
+#define SENSOR_ROSTER_SIZE      (MAX_TEMPERATURE_SENSORS*2) // distinct sensor addresses referenced by queued samples
+
+// uncomment to move samples to flash (LittleFS) rather than discard them when the RAM buffer is full
+//#define REPORT_SPILL_TO_FLASH
+
+// sample flags
+#define SAMPLE_EVENT    0x01    // safety trip, switch or direction change. Kept in preference to periodic samples.
+#define SAMPLE_POWER_ON 0x02
+#define SAMPLE_MAIN_ON  0x04
+
+typedef struct {
+    uint32_t    taken_at;       // millis() when the sample was taken
+    uint8_t     flags;
+    uint8_t     nb_sensors;
+    float       desired_temperature;
+    float       temperature;
+    float       switch_offset_below;
+    float       switch_offset_above;
+    uint8_t     sensor_slot[MAX_TEMPERATURE_SENSORS];   // index into the sensor roster
+    float       sensor_temperature[MAX_TEMPERATURE_SENSORS];
+    char        text[REPORT_TEXT_LENGTH];
+} REPORT_SAMPLE;
+
+void startTelemetry();
+void fillSample(REPORT_SAMPLE *sample, float current_temperature, int8_t power_state, int8_t main_state,
+        float switch_offset_below, float switch_offset_above,
+        const char *comment, SENSOR_DATA *sensor_data, uint8_t is_event);
+void queueSample(REPORT_SAMPLE *sample);
+int nbQueuedSamples();
+REPORT_SAMPLE *getQueuedSample(int index);      // 0 is the oldest
+void setSamplesInFlight(int nb);                // protect the oldest samples from eviction while they're being sent
+void dropQueuedSamples(int nb);                 // remove the oldest samples once the server has accepted them
+unsigned char *getRosterAddr(uint8_t slot);
+void serviceTelemetry();
+
+char *formatSampleQuery(char *p, char *end, REPORT_SAMPLE *sample, uint32_t now);
+
+/* Compact binary format (persistent_data.telemetry_format == TELEMETRY_BINARY), sent as the body of a POST
+   with Content-Type application/x-thermostat-telemetry.
+   varint = unsigned LEB128. svarint = zigzag-encoded signed varint. Temperatures are hundredths of a degree C.
+
+    byte        version (TELEMETRY_BINARY_VERSION)
+    byte        flags: BATCH_HAS_ROSTER
+    varint      length of ident, followed by the ident
+    if BATCH_HAS_ROSTER:
+        varint  number of roster entries, followed by 8 address bytes for each.
+                Sent on the first request on each connection and whenever the roster changes;
+                otherwise the server uses the roster it last received on this connection.
+    varint      number of samples, then for each sample:
+        varint      age, seconds
+        byte        flags: SAMPLE_EVENT, SAMPLE_POWER_ON, SAMPLE_MAIN_ON, SAMPLE_SETTINGS
+        svarint     controlling temperature, as delta from previous sample's (from 0 for the first)
+        if SAMPLE_SETTINGS (first sample, or settings differ from previous sample):
+            svarint desired temperature
+            svarint switch offset below
+            svarint switch offset above
+        if SAMPLE_EVENT:
+            varint  length of report text, followed by the text
+        varint      number of sensor readings, then for each:
+            varint  roster index
+            svarint temperature, as delta from that sensor's reading in the last sample of this batch that had
+                    one (from 0 if none). That's not necessarily the previous sample: if a sensor is missing
+                    from a sample, its next reading is relative to the one before the gap. So a decoder keeps
+                    a running value per roster index, reset at the start of each batch, and adds to it only
+                    when that index appears (as testing/collector.cpp does).
+*/
+#define TELEMETRY_BINARY_VERSION    1
+#define TELEMETRY_HEADER_SPACE      (8 + 64 + 2 + SENSOR_ROSTER_SIZE*8) // room for everything before the samples
+#define BATCH_HAS_ROSTER            0x01
+#define SAMPLE_SETTINGS             0x08    // in binary-encoded samples only
+
+uint32_t getRosterVersion();
+int encodeSamplesBinary(char *p, char *end, char **encoded_end, uint32_t now);
+char *encodeBatchHeaderBinary(char *p, char *end, int nb_samples, uint8_t with_roster);
+char *encodeOneSampleBinary(char *p, char *end, REPORT_SAMPLE *sample, uint32_t now);
+
+#endif  // _TELEMETRY_H
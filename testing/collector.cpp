@@ -0,0 +1,891 @@
+/* Licensed under GNU General Public License v3.0
+  See https://github.com/jeffasuk/thermostat
+  jeff at jamcupboard.co.uk
+*/
+/* Reference collector for thermostat reports. For development and load testing; not part of production code.
+   Build:   g++ -O2 -pthread -o collector collector.cpp
+   Run:     collector [-p port] [-t threads] [-c cfgpath] [-s settings_dir] [-o logfile | -q] [-a ack_every] [-i stats_sec]
+
+   Accepts everything the thermostat can send (see network.cpp and telemetry.h):
+        GET <rptpath>?<query>                   a single report
+        POST text/plain                         several reports, one query string per line
+        POST application/x-thermostat-telemetry the binary format, sensor roster kept per connection
+        UDP datagrams on the same port          "seq=<n>&<query>", or varint seq + binary batch of one sample
+   Each report is given the next sequence number for its unit (by ident) and written to the log as
+        <seq> <query string>
+   Binary reports are turned back into the same query format, so all transports give the same log.
+   UDP gaps are tracked per unit and acknowledged every ack_every datagrams ("ack=<seq>&lost=<n>").
+
+   GET <cfgpath>?ident=<ident> returns the file <settings_dir>/<ident>, which should hold name=value lines,
+   with an ETag. A matching If-None-Match gets a 304 with no body.
+
+   Each thread has its own epoll loop and its own TCP and UDP sockets on the port (SO_REUSEPORT),
+   so the kernel spreads connections and datagrams across the cores with no hand-off between threads.
+   HTTP/1.1 keep-alive and pipelined requests are supported.
+*/
+#include <arpa/inet.h>
+#include <ctype.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#define REQUEST_BUF_SIZE    16384   // the thermostat's requests are at most 2048 bytes
+#define RESPONSE_BUF_SIZE   8192
+#define SETTINGS_MAX_SIZE   4096
+#define LOG_BUF_SIZE        65536
+#define ROSTER_SIZE         64
+#define MAX_EVENTS          256
+#define NB_SHARDS           64
+
+// from telemetry.h
+#define TELEMETRY_BINARY_VERSION    1
+#define BATCH_HAS_ROSTER            0x01
+#define SAMPLE_EVENT                0x01
+#define SAMPLE_POWER_ON             0x02
+#define SAMPLE_MAIN_ON              0x04
+#define SAMPLE_SETTINGS             0x08
+
+static int          port = 8080;
+static int          nb_threads = 0;
+static const char   *cfg_path = "/config";
+static const char   *settings_dir = 0;
+static FILE         *log_file = stdout;
+static int          ack_every = 10;
+static int          stats_sec = 10;
+
+static std::atomic<uint64_t> nb_reports(0);
+static std::atomic<uint64_t> nb_requests(0);
+static std::atomic<uint64_t> nb_datagrams(0);
+static std::atomic<uint64_t> nb_bad(0);
+static std::atomic<uint64_t> nb_settings(0);
+static std::atomic<uint64_t> nb_not_modified(0);
+static std::atomic<uint64_t> nb_udp_lost(0);
+static std::mutex log_lock;
+
+typedef struct {
+    uint64_t    seq;            // last sequence number given to a report from this unit
+    uint32_t    udp_seq;        // highest UDP sequence number seen
+    uint32_t    udp_lost;       // gaps since the last ack
+    uint32_t    udp_since_ack;
+} UNIT;
+
+// Units are spread across shards by ident, so threads rarely contend for a lock
+static struct {
+    std::mutex                              lock;
+    std::unordered_map<std::string, UNIT>   units;
+} shards[NB_SHARDS];
+
+typedef struct {
+    int         fd;
+    size_t      in_len;
+    size_t      out_len;
+    size_t      out_sent;
+    uint8_t     close_after;
+    uint8_t     writing;                // EPOLLOUT is set
+    int         nb_roster;
+    uint8_t     roster[ROSTER_SIZE][8];
+    char        in[REQUEST_BUF_SIZE];
+    char        out[RESPONSE_BUF_SIZE];
+} CONNECTION;
+
+typedef struct {
+    int     epoll_fd;
+    int     listen_fd;
+    int     udp_fd;
+    size_t  log_len;
+    char    log[LOG_BUF_SIZE];
+} WORKER;
+
+static uint32_t fnv1a(const char *p, size_t len)
+{
+    uint32_t h = 2166136261u;
+    while (len--)
+    {
+        h = (h ^ (unsigned char)*p++) * 16777619u;
+    }
+    return h;
+}
+
+static UNIT *lockUnit(const char *ident, size_t len, std::mutex **lock)
+{
+    int shard = fnv1a(ident, len) % NB_SHARDS;
+    *lock = &shards[shard].lock;
+    (*lock)->lock();
+    return &shards[shard].units[std::string(ident, len)];
+}
+
+static void flushLog(WORKER *w)
+{
+    if (w->log_len && log_file)
+    {
+        std::lock_guard<std::mutex> guard(log_lock);
+        fwrite(w->log, 1, w->log_len, log_file);
+        fflush(log_file);
+    }
+    w->log_len = 0;
+}
+
+// Find a parameter in a query string. Returns its length, or -1 if it isn't there.
+static int queryParam(const char *query, size_t len, const char *name, const char **value)
+{
+    size_t name_len = strlen(name);
+    const char *p = query, *end = query + len;
+    while (p < end)
+    {
+        const char *amp = (const char*)memchr(p, '&', end - p);
+        const char *param_end = amp ? amp : end;
+        if ((size_t)(param_end - p) > name_len && !memcmp(p, name, name_len) && p[name_len] == '=')
+        {
+            *value = p + name_len + 1;
+            return param_end - *value;
+        }
+        p = param_end + 1;
+    }
+    return -1;
+}
+
+// Give the report its unit's next sequence number and log it
+static void recordQuery(WORKER *w, const char *query, size_t len)
+{
+    const char *ident;
+    int ident_len = queryParam(query, len, "ident", &ident);
+    std::mutex *lock;
+    uint64_t seq;
+    if (ident_len < 0)
+    {
+        ++nb_bad;
+        return;
+    }
+    seq = ++lockUnit(ident, ident_len, &lock)->seq;
+    lock->unlock();
+    ++nb_reports;
+    if (!log_file)
+    {
+        return;
+    }
+    if (w->log_len + len + 32 > LOG_BUF_SIZE)
+    {
+        flushLog(w);
+        if (len + 32 > LOG_BUF_SIZE)
+        {
+            return;
+        }
+    }
+    w->log_len += sprintf(w->log + w->log_len, "%llu ", (unsigned long long)seq);
+    memcpy(w->log + w->log_len, query, len);
+    w->log_len += len;
+    w->log[w->log_len++] = '\n';
+}
+
+/* Binary format */
+
+typedef struct {
+    const uint8_t   *p;
+    const uint8_t   *end;
+    int             ok;
+} READER;
+
+static uint32_t readByte(READER *r)
+{
+    if (r->p >= r->end)
+    {
+        r->ok = 0;
+        return 0;
+    }
+    return *r->p++;
+}
+
+static uint32_t readVarint(READER *r)
+{
+    uint32_t n = 0;
+    int shift;
+    for (shift = 0; shift < 35; shift += 7)
+    {
+        uint32_t b = readByte(r);
+        n |= (b & 0x7f) << shift;
+        if (!(b & 0x80))
+        {
+            return n;
+        }
+    }
+    r->ok = 0;
+    return 0;
+}
+
+static int32_t readSvarint(READER *r)
+{
+    uint32_t n = readVarint(r);
+    return (int32_t)(n >> 1) ^ -(int32_t)(n & 1);
+}
+
+static const char *readBytes(READER *r, uint32_t *len)
+{
+    const char *bytes;
+    *len = readVarint(r);
+    if (!r->ok || *len > (uint32_t)(r->end - r->p))
+    {
+        r->ok = 0;
+        *len = 0;
+        return "";
+    }
+    bytes = (const char*)r->p;
+    r->p += *len;
+    return bytes;
+}
+
+static char *appendCenti(char *p, int32_t centi)
+{
+    return p + sprintf(p, "%s%d.%02d", centi < 0 ? "-" : "", abs(centi) / 100, abs(centi) % 100);
+}
+
+// Decode a binary batch and log each sample in query format. Returns 0 if it's malformed.
+static int decodeBinary(WORKER *w, const char *data, size_t len, int *nb_roster, uint8_t roster[][8])
+{
+    READER r = {(const uint8_t*)data, (const uint8_t*)data + len, 1};
+    const char *ident;
+    uint32_t ident_len, nb_samples, batch_flags;
+    int32_t temperature = 0, desired = 0, below = 0, above = 0;
+    int32_t sensor[ROSTER_SIZE] = {0};
+    char query[4096];
+
+    if (readByte(&r) != TELEMETRY_BINARY_VERSION)
+    {
+        return 0;
+    }
+    batch_flags = readByte(&r);
+    ident = readBytes(&r, &ident_len);
+    if (ident_len > 64)
+    {
+        return 0;
+    }
+    if (batch_flags & BATCH_HAS_ROSTER)
+    {
+        uint32_t n = readVarint(&r);
+        if (n > ROSTER_SIZE)
+        {
+            return 0;
+        }
+        for (uint32_t slot = 0; slot < n; ++slot)
+        {
+            for (int i = 0; i < 8; ++i)
+            {
+                roster[slot][i] = readByte(&r);
+            }
+        }
+        *nb_roster = n;
+    }
+    nb_samples = readVarint(&r);
+    for (uint32_t s = 0; s < nb_samples && r.ok; ++s)
+    {
+        char *q = query;
+        uint32_t age = readVarint(&r);
+        uint32_t flags = readByte(&r);
+        uint32_t text_len = 0, nb_sensors;
+        const char *text = "";
+        temperature += readSvarint(&r);
+        if (flags & SAMPLE_SETTINGS)
+        {
+            desired = readSvarint(&r);
+            below = readSvarint(&r);
+            above = readSvarint(&r);
+        }
+        if (flags & SAMPLE_EVENT)
+        {
+            text = readBytes(&r, &text_len);
+            if (text_len > 200)
+            {
+                return 0;
+            }
+        }
+        q += sprintf(q, "ident=%.*s&des=", (int)ident_len, ident);
+        q = appendCenti(q, desired);
+        q = appendCenti(q + sprintf(q, "&tmp="), temperature);
+        q = appendCenti(q + sprintf(q, "&below="), below);
+        q = appendCenti(q + sprintf(q, "&above="), above);
+        q += sprintf(q, "&power=%s&main=%s&txt=", (flags & SAMPLE_POWER_ON) ? "on" : "off",
+                        (flags & SAMPLE_MAIN_ON) ? "on" : "off");
+        for (uint32_t i = 0; i < text_len; ++i)
+        {
+            *q++ = (text[i] == ' ' || (unsigned char)text[i] < ' ') ? '+' : text[i];
+        }
+        nb_sensors = readVarint(&r);
+        if (nb_sensors > 16)
+        {
+            return 0;
+        }
+        for (uint32_t i = 0; i < nb_sensors; ++i)
+        {
+            uint32_t slot = readVarint(&r);
+            if (slot >= (uint32_t)*nb_roster)
+            {
+                return 0;   // roster wasn't sent on this connection
+            }
+            sensor[slot] += readSvarint(&r);
+            q += sprintf(q, "&sensor_");
+            for (int b = 0; b < 8; ++b)
+            {
+                q += sprintf(q, "%02X", roster[slot][b]);
+            }
+            q = appendCenti(q + sprintf(q, "="), sensor[slot]);
+        }
+        if (age)
+        {
+            q += sprintf(q, "&age=%u", age);
+        }
+        if (r.ok)
+        {
+            recordQuery(w, query, q - query);
+        }
+    }
+    return r.ok;
+}
+
+/* HTTP */
+
+static void respond(CONNECTION *c, int status, const char *reason, const char *extra_headers,
+                    const char *body, size_t body_len)
+{
+    int n = snprintf(c->out + c->out_len, RESPONSE_BUF_SIZE - c->out_len,
+                    "HTTP/1.1 %d %s\r\nContent-Length: %u\r\n%s%s\r\n", status, reason, (unsigned)body_len,
+                    extra_headers, c->close_after ? "Connection: close\r\n" : "");
+    if (n < 0 || c->out_len + n + body_len > RESPONSE_BUF_SIZE)
+    {
+        c->close_after = 1;     // too many pipelined responses waiting; shouldn't happen with a real unit
+        return;
+    }
+    c->out_len += n;
+    memcpy(c->out + c->out_len, body, body_len);
+    c->out_len += body_len;
+}
+
+static int validIdent(const char *ident, int len)
+{
+    if (len <= 0 || len > 64 || ident[0] == '.')
+    {
+        return 0;
+    }
+    for (int i = 0; i < len; ++i)
+    {
+        char ch = ident[i];
+        if (!(isalnum((unsigned char)ch) || ch == '-' || ch == '_' || ch == '.'))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void serveSettings(CONNECTION *c, const char *query, size_t query_len, const char *if_none_match)
+{
+    const char *ident;
+    int ident_len = queryParam(query, query_len, "ident", &ident);
+    char path[1024], etag[64], headers[128], body[SETTINGS_MAX_SIZE];
+    struct stat st;
+    FILE *inf;
+    size_t len;
+
+    if (!settings_dir || !validIdent(ident, ident_len))
+    {
+        respond(c, 404, "Not Found", "", "", 0);
+        return;
+    }
+    snprintf(path, sizeof path, "%s/%.*s", settings_dir, ident_len, ident);
+    if (stat(path, &st) || (inf = fopen(path, "r")) == 0)
+    {
+        respond(c, 404, "Not Found", "", "", 0);
+        return;
+    }
+    // A change to the file changes its size or modification time, so that's enough for an ETag
+    snprintf(etag, sizeof etag, "\"%lx-%lx-%lx\"", (long)st.st_mtim.tv_sec, (long)st.st_mtim.tv_nsec, (long)st.st_size);
+    snprintf(headers, sizeof headers, "ETag: %s\r\nContent-Type: text/plain\r\n", etag);
+    ++nb_settings;
+    if (if_none_match && !strcmp(if_none_match, etag))
+    {
+        fclose(inf);
+        ++nb_not_modified;
+        respond(c, 304, "Not Modified", headers, "", 0);
+        return;
+    }
+    len = fread(body, 1, sizeof body, inf);
+    fclose(inf);
+    respond(c, 200, "OK", headers, body, len);
+}
+
+static void handleRequest(WORKER *w, CONNECTION *c, char *method, char *target, char *content_type,
+                          char *if_none_match, char *body, size_t body_len)
+{
+    char *query = strchr(target, '?');
+    size_t query_len = 0;
+    ++nb_requests;
+    if (query)
+    {
+        *(query++) = '\0';
+        query_len = strlen(query);
+    }
+    if (!strcmp(method, "GET"))
+    {
+        if (!strcmp(target, cfg_path))
+        {
+            serveSettings(c, query, query_len, if_none_match);
+        }
+        else if (query)
+        {
+            recordQuery(w, query, query_len);
+            respond(c, 200, "OK", "", "", 0);
+        }
+        else
+        {
+            respond(c, 404, "Not Found", "", "", 0);
+        }
+    }
+    else if (!strcmp(method, "POST"))
+    {
+        if (content_type && !strcmp(content_type, "application/x-thermostat-telemetry"))
+        {
+            if (!decodeBinary(w, body, body_len, &c->nb_roster, c->roster))
+            {
+                ++nb_bad;
+                respond(c, 400, "Bad Request", "", "", 0);
+                return;
+            }
+        }
+        else
+        {
+            char *p = body, *end = body + body_len;
+            while (p < end)
+            {
+                char *nl = (char*)memchr(p, '\n', end - p);
+                char *line_end = nl ? nl : end;
+                if (line_end > p)
+                {
+                    recordQuery(w, p, line_end - p);
+                }
+                p = line_end + 1;
+            }
+        }
+        respond(c, 200, "OK", "", "", 0);
+    }
+    else
+    {
+        c->close_after = 1;
+        respond(c, 405, "Method Not Allowed", "", "", 0);
+    }
+}
+
+// Find a header without altering the request. The value ends at the next CR.
+static char *findHeader(char *start, char *headers_end, const char *name)
+{
+    size_t name_len = strlen(name);
+    char *line = (char*)memmem(start, headers_end - start, "\r\n", 2);
+    while (line)
+    {
+        line += 2;
+        if ((size_t)(headers_end - line) > name_len && !strncasecmp(line, name, name_len) && line[name_len] == ':')
+        {
+            char *value = line + name_len + 1;
+            while (*value == ' ')
+            {
+                ++value;
+            }
+            return value;
+        }
+        line = (char*)memmem(line, headers_end - line, "\r\n", 2);
+    }
+    return 0;
+}
+
+// Handle every complete request in the input buffer. Returns 0 if the connection should be dropped now.
+static int processInput(WORKER *w, CONNECTION *c)
+{
+    size_t used = 0;
+    while (!c->close_after)
+    {
+        char *start = c->in + used;
+        char *headers_end = (char*)memmem(start, c->in_len - used, "\r\n\r\n", 4);
+        char *p, *method, *target, *version, *connection;
+        char *content_type, *if_none_match, *content_length_str;
+        long content_length = 0;
+        size_t header_len;
+        if (!headers_end)
+        {
+            if (c->in_len - used == REQUEST_BUF_SIZE)
+            {
+                return 0;   // headers too long
+            }
+            break;
+        }
+        header_len = headers_end + 4 - start;
+        if ( (content_length_str = findHeader(start, headers_end, "Content-Length")) != 0)
+        {
+            content_length = atol(content_length_str);
+        }
+        if (content_length < 0 || header_len + content_length > REQUEST_BUF_SIZE)
+        {
+            return 0;
+        }
+        if (used + header_len + content_length > c->in_len)
+        {
+            break;  // wait for the rest of the body
+        }
+
+        // The request is all here, so it can be cut up into strings
+        content_type = findHeader(start, headers_end, "Content-Type");
+        if_none_match = findHeader(start, headers_end, "If-None-Match");
+        connection = findHeader(start, headers_end, "Connection");
+        for (p = start; p < headers_end; ++p)
+        {
+            if (*p == '\r')
+            {
+                *p = '\0';
+            }
+        }
+        *headers_end = '\0';
+        method = start;
+        if ( (target = strchr(method, ' ')) == 0 || (version = strchr(target + 1, ' ')) == 0)
+        {
+            return 0;
+        }
+        *(target++) = '\0';
+        *(version++) = '\0';
+        c->close_after = connection ? !strcasecmp(connection, "close")
+                                    : strcmp(version, "HTTP/1.1") != 0;    // 1.0 closes unless asked not to
+        handleRequest(w, c, method, target, content_type, if_none_match, start + header_len, content_length);
+        used += header_len + content_length;
+    }
+    if (used)
+    {
+        memmove(c->in, c->in + used, c->in_len - used);
+        c->in_len -= used;
+    }
+    return 1;
+}
+
+static void closeConnection(WORKER *w, CONNECTION *c)
+{
+    epoll_ctl(w->epoll_fd, EPOLL_CTL_DEL, c->fd, 0);
+    close(c->fd);
+    free(c);
+}
+
+// Returns 0 if the connection has been closed
+static int writeOutput(WORKER *w, CONNECTION *c)
+{
+    while (c->out_sent < c->out_len)
+    {
+        ssize_t n = send(c->fd, c->out + c->out_sent, c->out_len - c->out_sent, MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno == EAGAIN)
+            {
+                break;
+            }
+            closeConnection(w, c);
+            return 0;
+        }
+        c->out_sent += n;
+    }
+    if (c->out_sent == c->out_len)
+    {
+        c->out_sent = c->out_len = 0;
+        if (c->close_after)
+        {
+            closeConnection(w, c);
+            return 0;
+        }
+    }
+    uint8_t want_write = c->out_len != 0;
+    if (want_write != c->writing)
+    {
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLRDHUP | (want_write ? (uint32_t)EPOLLOUT : 0u);
+        ev.data.ptr = c;
+        epoll_ctl(w->epoll_fd, EPOLL_CTL_MOD, c->fd, &ev);
+        c->writing = want_write;
+    }
+    return 1;
+}
+
+static void readInput(WORKER *w, CONNECTION *c)
+{
+    for (;;)
+    {
+        ssize_t n = recv(c->fd, c->in + c->in_len, REQUEST_BUF_SIZE - c->in_len, 0);
+        if (n == 0 || (n < 0 && errno != EAGAIN))
+        {
+            closeConnection(w, c);
+            return;
+        }
+        if (n < 0)
+        {
+            break;
+        }
+        c->in_len += n;
+        if (!processInput(w, c))
+        {
+            ++nb_bad;
+            closeConnection(w, c);
+            return;
+        }
+        if (c->close_after || c->out_len)
+        {
+            break;  // send what we have before reading any more
+        }
+    }
+    writeOutput(w, c);
+}
+
+/* UDP */
+
+static void handleDatagram(WORKER *w, char *data, size_t len, struct sockaddr_in *from)
+{
+    uint32_t seq;
+    const char *ident;
+    int ident_len;
+    char binary_ident[65];
+    std::mutex *lock;
+    UNIT *unit;
+    char ack[64];
+    int ack_len = 0;
+
+    ++nb_datagrams;
+    if (len > 4 && !memcmp(data, "seq=", 4))
+    {
+        char *amp = (char*)memchr(data, '&', len);
+        if (!amp)
+        {
+            ++nb_bad;
+            return;
+        }
+        seq = strtoul(data + 4, 0, 10);
+        ident_len = queryParam(amp + 1, data + len - amp - 1, "ident", &ident);
+        if (ident_len < 0)
+        {
+            ++nb_bad;
+            return;
+        }
+        recordQuery(w, amp + 1, data + len - amp - 1);
+    }
+    else
+    {
+        READER r = {(const uint8_t*)data, (const uint8_t*)data + len, 1};
+        uint8_t roster[ROSTER_SIZE][8];
+        int nb_roster = 0;
+        uint32_t n;
+        seq = readVarint(&r);
+        // peek at the ident: version, flags, ident
+        READER peek = r;
+        readByte(&peek);
+        readByte(&peek);
+        ident = readBytes(&peek, &n);
+        if (!r.ok || !peek.ok || n >= sizeof binary_ident
+                || !decodeBinary(w, (const char*)r.p, r.end - r.p, &nb_roster, roster))
+        {
+            ++nb_bad;
+            return;
+        }
+        memcpy(binary_ident, ident, n);
+        ident = binary_ident;
+        ident_len = n;
+    }
+
+    unit = lockUnit(ident, ident_len, &lock);
+    if (unit->udp_seq && seq > unit->udp_seq + 1)
+    {
+        unit->udp_lost += seq - unit->udp_seq - 1;
+        nb_udp_lost += seq - unit->udp_seq - 1;
+    }
+    if (seq > unit->udp_seq || seq == 1)   // 1: unit has restarted
+    {
+        unit->udp_seq = seq;
+    }
+    if (++unit->udp_since_ack >= (uint32_t)ack_every)
+    {
+        ack_len = snprintf(ack, sizeof ack, "ack=%u&lost=%u", unit->udp_seq, unit->udp_lost);
+        unit->udp_lost = unit->udp_since_ack = 0;
+    }
+    lock->unlock();
+    if (ack_len)
+    {
+        sendto(w->udp_fd, ack, ack_len, 0, (struct sockaddr*)from, sizeof *from);
+    }
+}
+
+static void readDatagrams(WORKER *w)
+{
+    char buf[2048];
+    struct sockaddr_in from;
+    socklen_t from_len;
+    ssize_t n;
+    while (from_len = sizeof from, (n = recvfrom(w->udp_fd, buf, sizeof buf, 0, (struct sockaddr*)&from, &from_len)) >= 0)
+    {
+        handleDatagram(w, buf, n, &from);
+    }
+}
+
+/* Threads */
+
+static int openSocket(int type)
+{
+    int fd = socket(AF_INET, type | SOCK_NONBLOCK, 0);
+    int one = 1;
+    struct sockaddr_in addr;
+    if (fd < 0)
+    {
+        perror("socket");
+        exit(1);
+    }
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof one);
+    memset(&addr, 0, sizeof addr);
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof addr))
+    {
+        perror("bind");
+        exit(1);
+    }
+    if (type == SOCK_STREAM && listen(fd, 4096))
+    {
+        perror("listen");
+        exit(1);
+    }
+    return fd;
+}
+
+static void *worker(void *arg)
+{
+    WORKER *w = (WORKER*)arg;
+    struct epoll_event ev, events[MAX_EVENTS];
+    // the listening and UDP sockets are told apart from connections by these pointers
+    ev.events = EPOLLIN;
+    ev.data.ptr = &w->listen_fd;
+    epoll_ctl(w->epoll_fd, EPOLL_CTL_ADD, w->listen_fd, &ev);
+    ev.data.ptr = &w->udp_fd;
+    epoll_ctl(w->epoll_fd, EPOLL_CTL_ADD, w->udp_fd, &ev);
+
+    for (;;)
+    {
+        int nb = epoll_wait(w->epoll_fd, events, MAX_EVENTS, 100);
+        for (int i = 0; i < nb; ++i)
+        {
+            void *ptr = events[i].data.ptr;
+            if (ptr == &w->listen_fd)
+            {
+                int fd, one = 1;
+                while ( (fd = accept4(w->listen_fd, 0, 0, SOCK_NONBLOCK)) >= 0)
+                {
+                    CONNECTION *c = (CONNECTION*)malloc(sizeof *c);
+                    memset(c, 0, offsetof(CONNECTION, roster));
+                    c->fd = fd;
+                    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+                    ev.events = EPOLLIN | EPOLLRDHUP;
+                    ev.data.ptr = c;
+                    epoll_ctl(w->epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+                }
+            }
+            else if (ptr == &w->udp_fd)
+            {
+                readDatagrams(w);
+            }
+            else
+            {
+                CONNECTION *c = (CONNECTION*)ptr;
+                if (events[i].events & EPOLLOUT)
+                {
+                    if (!writeOutput(w, c))
+                    {
+                        continue;
+                    }
+                }
+                if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+                {
+                    readInput(w, c);
+                }
+            }
+        }
+        if (nb < MAX_EVENTS)
+        {
+            flushLog(w);    // not busy, so don't keep log lines waiting
+        }
+    }
+    return 0;
+}
+
+static void usage()
+{
+    fprintf(stderr, "usage: collector [-p port] [-t threads] [-c cfgpath] [-s settings_dir] [-o logfile | -q]"
+                    " [-a ack_every] [-i stats_sec]\n");
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    int opt;
+    uint64_t last_reports = 0;
+    while ( (opt = getopt(argc, argv, "p:t:c:s:o:qa:i:")) != -1)
+    {
+        switch (opt)
+        {
+          case 'p': port = atoi(optarg); break;
+          case 't': nb_threads = atoi(optarg); break;
+          case 'c': cfg_path = optarg; break;
+          case 's': settings_dir = optarg; break;
+          case 'o':
+            if ( (log_file = fopen(optarg, "a")) == 0)
+            {
+                perror(optarg);
+                return 1;
+            }
+            break;
+          case 'q': log_file = 0; break;
+          case 'a': ack_every = atoi(optarg); break;
+          case 'i': stats_sec = atoi(optarg); break;
+          default: usage();
+        }
+    }
+    if (nb_threads <= 0)
+    {
+        nb_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    signal(SIGPIPE, SIG_IGN);
+    for (int i = 0; i < nb_threads; ++i)
+    {
+        WORKER *w = (WORKER*)calloc(1, sizeof *w);
+        pthread_t thread;
+        w->epoll_fd = epoll_create1(0);
+        w->listen_fd = openSocket(SOCK_STREAM);
+        w->udp_fd = openSocket(SOCK_DGRAM);
+        pthread_create(&thread, 0, worker, w);
+    }
+    fprintf(stderr, "collector: port %d, %d thread(s), settings %s from %s\n", port, nb_threads,
+            cfg_path, settings_dir ? settings_dir : "(none)");
+    for (;;)
+    {
+        sleep(stats_sec);
+        uint64_t reports = nb_reports;
+        fprintf(stderr, "%.0f reports/s  total: %llu reports, %llu requests, %llu datagrams (%llu lost),"
+                        " %llu settings (%llu not modified), %llu bad\n",
+                (double)(reports - last_reports) / stats_sec, (unsigned long long)reports,
+                (unsigned long long)nb_requests, (unsigned long long)nb_datagrams, (unsigned long long)nb_udp_lost,
+                (unsigned long long)nb_settings, (unsigned long long)nb_not_modified, (unsigned long long)nb_bad);
+        last_reports = reports;
+    }
+    return 0;
+}
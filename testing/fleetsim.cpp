@@ -0,0 +1,730 @@
+/* Licensed under GNU General Public License v3.0
+  See https://github.com/jeffasuk/thermostat
+  jeff at jamcupboard.co.uk
+*/
+/* Fleet load generator: runs many virtual thermostats against a report server (e.g. collector.cpp),
+   to find out how many units a server can take. For development and load testing; not part of production code.
+   Build:   g++ -O2 -pthread -I.. -o fleetsim fleetsim.cpp ../httpparser.cpp
+   Run:     fleetsim [options] host port
+        -n units        number of virtual units (default 1000)
+        -x speedup      simulated seconds per real second (default 1)
+        -d seconds      how long to run, real time (default 60)
+        -a pattern      arrival pattern: steady (spread evenly), burst (all in step, as after a power cut),
+                        random (default steady)
+        -r seconds      bring the units up gradually over this long (default 0: all at once)
+        -k policy       keepalive (one open connection per unit, as the unit does) or close (new
+                        connection for every request, as old firmware did) (default keepalive)
+        -m seconds      max_time_between_reports (default 20, as the unit's default)
+        -P path         report path (default /)
+        -t threads      (default 1)
+        -i seconds      statistics interval (default 10)
+
+   Each unit has its own plant, modelled as in heatersim.py, and simple on/off control with switch offsets.
+   Like the real unit, it reports on switching and on a change of direction, and otherwise every
+   max_time_between_reports. Requests have the unit's exact shape: a GET with the query string for a single
+   report, or a text/plain POST with one query string per line when reports have built up while the server
+   was slow. A unit has one request outstanding at a time, with the unit's 5 s timeout and retry back-off.
+   Responses go through the unit's own parser (httpparser.cpp), and name=value settings in them are applied.
+
+   Latency (request written to response complete) goes into log2 histograms, printed with percentiles
+   every interval and at the end, along with request, error and timeout counts and the backlog of reports
+   waiting to be sent, which is what grows when the server can't keep up.
+*/
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include "httpparser.h"
+
+#define MAX_PENDING         24      // as REPORT_QUEUE_LENGTH
+#define REQUEST_SIZE        2048    // as REPORT_REQUEST_SIZE
+#define TIMEOUT_MS          5000    // as REPORT_TIMEOUT_MS
+#define RETRY_MIN_MS        2000
+#define RETRY_MAX_MS        60000
+#define NB_BUCKETS          32      // latency histogram: bucket b holds [2^b, 2^(b+1)) microseconds
+#define TICK_MS             10
+
+// plant, from heatersim.py
+#define HEAT_RATE           0.1     // degrees per second that the heating element gains while on
+#define COOL_DELTA_RATIO    0.02    // proportion per second by which the element approaches ambient
+#define TRANSFER_DELTA_RATIO 0.005  // proportion per second by which the room approaches the element
+#define MAX_ELEMENT_TEMP    65
+
+enum {ARRIVE_STEADY, ARRIVE_BURST, ARRIVE_RANDOM};
+enum {UNIT_WAITING, UNIT_IDLE, UNIT_CONNECTING, UNIT_AWAITING_RESPONSE};
+
+typedef struct {
+    double  taken_at;           // simulated seconds
+    float   desired;
+    float   temperature;
+    float   below;
+    float   above;
+    uint8_t power;
+    char    text[40];
+} REPORT;
+
+typedef struct {
+    char        ident[24];
+    // plant
+    float       temperature;
+    float       element;
+    float       ambient;
+    // control and settings
+    float       desired;
+    float       precision;
+    float       below;
+    float       above;
+    uint32_t    max_time_between_reports;
+    uint8_t     power;
+    int8_t      direction;
+    float       extreme;            // highest or lowest temperature since the last change of direction
+    double      next_step_at;       // simulated seconds
+    double      last_report_at;
+    // reporting
+    int         nb_pending;
+    REPORT      pending[MAX_PENDING];
+    int         nb_in_flight;
+    int         state;
+    int         fd;
+    uint64_t    start_at_ms;        // real time at which the unit comes up
+    uint64_t    request_started_us;
+    uint64_t    retry_at_ms;
+    uint32_t    retry_delay_ms;
+    uint8_t     reused;
+    int         request_len;
+    int         request_sent;
+    char        request[REQUEST_SIZE];
+    HTTP_PARSER parser;
+} UNIT;
+
+typedef struct {
+    int     epoll_fd;
+    int     first_unit;
+    int     nb_units;
+} THREAD;
+
+static struct sockaddr_in server_addr;
+static const char   *server_host;
+static const char   *report_path = "/";
+static int          nb_units = 1000;
+static double       speedup = 1;
+static int          duration_sec = 60;
+static int          arrival = ARRIVE_STEADY;
+static int          ramp_sec = 0;
+static int          keepalive = 1;
+static int          max_time_between_reports = 20;
+static int          nb_threads = 1;
+static int          stats_sec = 10;
+static UNIT         *units;
+static uint64_t     start_us;
+
+static std::atomic<uint64_t> histogram[NB_BUCKETS];
+static std::atomic<uint64_t> nb_requests(0), nb_reports_sent(0), nb_reports_dropped(0);
+static std::atomic<uint64_t> nb_errors(0), nb_timeouts(0), nb_connects(0), nb_settings_changed(0);
+static std::atomic<int64_t>  backlog(0);
+
+static uint64_t nowUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static double simNow()
+{
+    return (nowUs() - start_us) / 1e6 * speedup;
+}
+
+static float frand(float lo, float hi)
+{
+    return lo + (hi - lo) * (rand() / (float)RAND_MAX);
+}
+
+/* Plant and control */
+
+static void queueReport(UNIT *u, double now, const char *text)
+{
+    REPORT *r;
+    if (u->nb_pending == MAX_PENDING)
+    {
+        // as the unit does, lose the oldest report that isn't being sent (simplified: events aren't favoured)
+        ++nb_reports_dropped;
+        if (u->nb_in_flight == MAX_PENDING)
+        {
+            return;
+        }
+        memmove(u->pending + u->nb_in_flight, u->pending + u->nb_in_flight + 1,
+                (MAX_PENDING - u->nb_in_flight - 1) * sizeof u->pending[0]);
+        --u->nb_pending;
+        --backlog;
+    }
+    r = &u->pending[u->nb_pending++];
+    ++backlog;
+    r->taken_at = now;
+    r->desired = u->desired;
+    r->temperature = u->temperature;
+    r->below = u->below;
+    r->above = u->above;
+    r->power = u->power;
+    snprintf(r->text, sizeof r->text, "%s", text);
+    u->last_report_at = now;
+}
+
+// One simulated second
+static void stepUnit(UNIT *u, double now)
+{
+    char text[40] = "";
+    // plant
+    if (u->power)
+    {
+        u->element = u->element + HEAT_RATE < MAX_ELEMENT_TEMP ? u->element + HEAT_RATE : MAX_ELEMENT_TEMP;
+    }
+    else
+    {
+        u->element += (u->ambient - u->element) * COOL_DELTA_RATIO;
+    }
+    u->temperature += (u->element - u->temperature) * TRANSFER_DELTA_RATIO;
+
+    // control: switch at the offsets, and report the change of direction once it's clear
+    if (!u->power && u->temperature < u->desired + u->below)
+    {
+        u->power = 1;
+        strcpy(text, "Turning on");
+    }
+    else if (u->power && u->temperature > u->desired + u->above)
+    {
+        u->power = 0;
+        strcpy(text, "Turning off");
+    }
+    else if (u->direction >= 0 && u->temperature < u->extreme - u->precision)
+    {
+        snprintf(text, sizeof text, "Going down from %.2f", u->extreme);
+        u->direction = -1;
+        u->extreme = u->temperature;
+    }
+    else if (u->direction <= 0 && u->temperature > u->extreme + u->precision)
+    {
+        snprintf(text, sizeof text, "Going up from %.2f", u->extreme);
+        u->direction = 1;
+        u->extreme = u->temperature;
+    }
+    if ((u->direction >= 0 && u->temperature > u->extreme) || (u->direction <= 0 && u->temperature < u->extreme))
+    {
+        u->extreme = u->temperature;
+    }
+    if (!text[0] && now - u->last_report_at > u->max_time_between_reports)
+    {
+        snprintf(text, sizeof text, "Time");
+    }
+    if (text[0])
+    {
+        queueReport(u, now, text);
+    }
+}
+
+static void initUnit(UNIT *u, int index)
+{
+    memset(u, 0, offsetof(UNIT, parser));
+    snprintf(u->ident, sizeof u->ident, "sim%05d", index);
+    u->ambient = frand(5, 15);
+    u->temperature = u->element = u->ambient + frand(0, 5);
+    u->desired = frand(18, 22);
+    u->precision = 0.2;
+    u->below = -0.5;
+    u->above = 0.5;
+    u->max_time_between_reports = max_time_between_reports;
+    u->extreme = u->temperature;
+    u->fd = -1;
+    u->state = UNIT_WAITING;
+    switch (arrival)
+    {
+      case ARRIVE_STEADY:
+        u->next_step_at = (double)index / nb_units;
+        u->last_report_at = -(double)index / nb_units * max_time_between_reports;
+        break;
+      case ARRIVE_BURST:
+        u->next_step_at = 0;
+        u->last_report_at = 0;
+        break;
+      case ARRIVE_RANDOM:
+        u->next_step_at = frand(0, 1);
+        u->last_report_at = -frand(0, max_time_between_reports);
+        break;
+    }
+    u->start_at_ms = ramp_sec ? (uint64_t)index * ramp_sec * 1000 / nb_units : 0;
+}
+
+/* Network */
+
+static void onHeader(void *, char *, char *)
+{
+}
+
+// as processLine(): each body line is name=value
+static void onBodyLine(void *arg, char *line)
+{
+    UNIT *u = (UNIT*)arg;
+    char *value = strchr(line, '=');
+    if (!value)
+    {
+        return;
+    }
+    *(value++) = '\0';
+    if (!strcmp(line, "desired_temperature"))
+    {
+        u->desired = atof(value);
+    }
+    else if (!strcmp(line, "precision"))
+    {
+        u->precision = atof(value);
+    }
+    else if (!strcmp(line, "max_time_between_reports"))
+    {
+        u->max_time_between_reports = atoi(value);
+    }
+    else
+    {
+        return;
+    }
+    ++nb_settings_changed;
+}
+
+static char *formatQuery(char *p, char *end, UNIT *u, REPORT *r, double now)
+{
+    int n;
+    uint32_t age = (uint32_t)(now - r->taken_at);
+    n = snprintf(p, end - p, "ident=%s&des=%.2f&tmp=%.2f&below=%.2f&above=%.2f&power=%s&main=%s&txt=",
+                u->ident, r->desired, r->temperature, r->below, r->above,
+                r->power ? "on" : "off", r->power ? "on" : "off");
+    if (n < 0 || n >= end - p)
+    {
+        return end;
+    }
+    p += n;
+    for (const char *t = r->text; *t && p < end; ++t)
+    {
+        *p++ = *t == ' ' ? '+' : *t;
+    }
+    if (age)
+    {
+        n = snprintf(p, end - p, "&age=%u", age);
+        if (n < 0 || n >= end - p)
+        {
+            return end;
+        }
+        p += n;
+    }
+    return p;
+}
+
+// As buildReportRequest(): GET for one report, POST of one line per report for more
+static void buildRequest(UNIT *u, double now)
+{
+    char *end = u->request + REQUEST_SIZE;
+    char *p;
+    if (u->nb_pending == 1)
+    {
+        p = u->request + sprintf(u->request, "GET %s?", report_path);
+        p = formatQuery(p, end, u, &u->pending[0], now);
+        p += snprintf(p, end - p, " HTTP/1.1\r\nHost:%s\r\n\r\n", server_host);
+        u->request_len = p - u->request;
+        u->nb_in_flight = 1;
+        return;
+    }
+    char body[REQUEST_SIZE];
+    char *b = body, *body_end = body + sizeof body - 256;
+    int n;
+    for (n = 0; n < u->nb_pending; ++n)
+    {
+        char *line_end = formatQuery(b, body_end, u, &u->pending[n], now);
+        if (line_end >= body_end - 1)
+        {
+            break;
+        }
+        *line_end++ = '\n';
+        b = line_end;
+    }
+    u->request_len = snprintf(u->request, REQUEST_SIZE,
+                "POST %s HTTP/1.1\r\nHost:%s\r\nContent-Type: text/plain\r\nContent-Length: %d\r\n\r\n",
+                report_path, server_host, (int)(b - body));
+    memcpy(u->request + u->request_len, body, b - body);
+    u->request_len += b - body;
+    u->nb_in_flight = n;
+}
+
+static void closeUnitConnection(THREAD *t, UNIT *u)
+{
+    if (u->fd >= 0)
+    {
+        epoll_ctl(t->epoll_fd, EPOLL_CTL_DEL, u->fd, 0);
+        close(u->fd);
+        u->fd = -1;
+    }
+}
+
+// As finishReport()
+static void finishRequest(THREAD *t, UNIT *u, int ok)
+{
+    uint64_t now_ms = nowUs() / 1000;
+    if (ok)
+    {
+        uint64_t us = nowUs() - u->request_started_us;
+        int b = 0;
+        while (us > 1 && b < NB_BUCKETS - 1)
+        {
+            us >>= 1;
+            ++b;
+        }
+        ++histogram[b];
+        nb_reports_sent += u->nb_in_flight;
+        backlog -= u->nb_in_flight;
+        memmove(u->pending, u->pending + u->nb_in_flight, (u->nb_pending - u->nb_in_flight) * sizeof u->pending[0]);
+        u->nb_pending -= u->nb_in_flight;
+        u->retry_delay_ms = 0;
+        if (u->parser.close || !keepalive)
+        {
+            closeUnitConnection(t, u);
+        }
+    }
+    else
+    {
+        closeUnitConnection(t, u);
+        if (!u->reused)
+        {
+            u->retry_delay_ms = u->retry_delay_ms ? (u->retry_delay_ms * 2 < RETRY_MAX_MS ? u->retry_delay_ms * 2
+                                                                                          : RETRY_MAX_MS)
+                                                  : RETRY_MIN_MS;
+            u->retry_at_ms = now_ms + u->retry_delay_ms;
+        }
+    }
+    u->nb_in_flight = 0;
+    u->state = UNIT_IDLE;
+}
+
+static void sendMore(THREAD *t, UNIT *u)
+{
+    while (u->request_sent < u->request_len)
+    {
+        ssize_t n = send(u->fd, u->request + u->request_sent, u->request_len - u->request_sent, MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno != EAGAIN)
+            {
+                ++nb_errors;
+                finishRequest(t, u, 0);
+            }
+            return;
+        }
+        u->request_sent += n;
+    }
+}
+
+static void startRequest(THREAD *t, UNIT *u, double now)
+{
+    struct epoll_event ev;
+    buildRequest(u, now);
+    u->request_sent = 0;
+    u->request_started_us = nowUs();
+    httpParserStart(&u->parser);
+    ++nb_requests;
+    if (u->fd >= 0)
+    {
+        u->reused = 1;
+        u->state = UNIT_AWAITING_RESPONSE;
+        sendMore(t, u);
+        return;
+    }
+    u->reused = 0;
+    u->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (u->fd < 0)
+    {
+        ++nb_errors;
+        finishRequest(t, u, 0);
+        return;
+    }
+    int one = 1;
+    setsockopt(u->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+    ++nb_connects;
+    if (connect(u->fd, (struct sockaddr*)&server_addr, sizeof server_addr) && errno != EINPROGRESS)
+    {
+        ++nb_errors;
+        finishRequest(t, u, 0);
+        return;
+    }
+    u->state = UNIT_CONNECTING;
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP;
+    ev.data.ptr = u;
+    epoll_ctl(t->epoll_fd, EPOLL_CTL_ADD, u->fd, &ev);
+}
+
+static void handleEvent(THREAD *t, UNIT *u, uint32_t events)
+{
+    if (u->state == UNIT_CONNECTING && (events & (EPOLLOUT | EPOLLERR | EPOLLHUP)))
+    {
+        int err = 0;
+        socklen_t len = sizeof err;
+        struct epoll_event ev;
+        getsockopt(u->fd, SOL_SOCKET, SO_ERROR, &err, &len);
+        if (err)
+        {
+            ++nb_errors;
+            finishRequest(t, u, 0);
+            return;
+        }
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.ptr = u;
+        epoll_ctl(t->epoll_fd, EPOLL_CTL_MOD, u->fd, &ev);
+        u->state = UNIT_AWAITING_RESPONSE;
+        sendMore(t, u);
+        if (u->state != UNIT_AWAITING_RESPONSE)
+        {
+            return;
+        }
+    }
+    if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+    {
+        char buf[4096];
+        ssize_t n;
+        while ( (n = recv(u->fd, buf, sizeof buf, 0)) > 0)
+        {
+            enum HTTP_PARSE_RESULT result;
+            if (u->state != UNIT_AWAITING_RESPONSE)
+            {
+                continue;   // unexpected data on an idle connection; ignore it
+            }
+            result = httpParserFeed(&u->parser, buf, n);
+            if (result == HTTP_DONE)
+            {
+                finishRequest(t, u, u->parser.status >= 200 && u->parser.status < 500);
+                if (u->parser.status >= 300)
+                {
+                    ++nb_errors;
+                }
+                if (u->fd < 0)
+                {
+                    return;
+                }
+            }
+            else if (result == HTTP_ERROR)
+            {
+                ++nb_errors;
+                finishRequest(t, u, 0);
+                return;
+            }
+        }
+        if (n == 0 || (n < 0 && errno != EAGAIN))
+        {
+            // closed by the server
+            if (u->state == UNIT_AWAITING_RESPONSE)
+            {
+                if (httpParserEof(&u->parser) == HTTP_DONE)
+                {
+                    finishRequest(t, u, 1);
+                }
+                else
+                {
+                    ++nb_errors;
+                    finishRequest(t, u, 0);
+                }
+            }
+            closeUnitConnection(t, u);
+        }
+    }
+}
+
+static void *runThread(void *arg)
+{
+    THREAD *t = (THREAD*)arg;
+    struct epoll_event events[256];
+    uint64_t end_us = start_us + duration_sec * 1000000ULL;
+    for (int i = t->first_unit; i < t->first_unit + t->nb_units; ++i)
+    {
+        httpParserInit(&units[i].parser, onHeader, onBodyLine, &units[i]);
+    }
+    while (nowUs() < end_us)
+    {
+        int nb = epoll_wait(t->epoll_fd, events, 256, TICK_MS);
+        uint64_t now_ms;
+        double now;
+        for (int i = 0; i < nb; ++i)
+        {
+            handleEvent(t, (UNIT*)events[i].data.ptr, events[i].events);
+        }
+        now_ms = (nowUs() - start_us) / 1000;
+        now = simNow();
+        for (int i = t->first_unit; i < t->first_unit + t->nb_units; ++i)
+        {
+            UNIT *u = &units[i];
+            if (u->state == UNIT_WAITING)
+            {
+                if (now_ms < u->start_at_ms)
+                {
+                    continue;
+                }
+                u->state = UNIT_IDLE;
+                u->next_step_at += now;
+                u->last_report_at += now;
+            }
+            while (u->next_step_at <= now)
+            {
+                stepUnit(u, u->next_step_at);
+                u->next_step_at += 1;
+            }
+            if (u->state == UNIT_IDLE && u->nb_pending
+                    && (!u->retry_delay_ms || nowUs() / 1000 >= u->retry_at_ms))
+            {
+                startRequest(t, u, now);
+            }
+            else if ((u->state == UNIT_CONNECTING || u->state == UNIT_AWAITING_RESPONSE)
+                    && nowUs() - u->request_started_us > TIMEOUT_MS * 1000ULL)
+            {
+                ++nb_timeouts;
+                finishRequest(t, u, 0);
+            }
+        }
+    }
+    return 0;
+}
+
+static void printStats(const char *title, double elapsed_sec, uint64_t requests)
+{
+    uint64_t counts[NB_BUCKETS], total = 0, cumulative = 0;
+    static const double percentiles[] = {50, 90, 99, 99.9};
+    int p = 0;
+    for (int b = 0; b < NB_BUCKETS; ++b)
+    {
+        counts[b] = histogram[b];
+        total += counts[b];
+    }
+    printf("%s: %.0f requests/s, %llu reports sent, %llu dropped, backlog %lld, %llu connects, %llu errors,"
+           " %llu timeouts, %llu settings applied\n",
+            title, requests / elapsed_sec, (unsigned long long)nb_reports_sent, (unsigned long long)nb_reports_dropped,
+            (long long)backlog, (unsigned long long)nb_connects, (unsigned long long)nb_errors,
+            (unsigned long long)nb_timeouts, (unsigned long long)nb_settings_changed);
+    if (!total)
+    {
+        return;
+    }
+    printf("  latency so far");
+    for (int b = 0; b < NB_BUCKETS && p < 4; ++b)
+    {
+        cumulative += counts[b];
+        while (p < 4 && cumulative * 100.0 >= total * percentiles[p])
+        {
+            printf("  p%g < %.3g ms", percentiles[p], (2ULL << b) / 1000.0);
+            ++p;
+        }
+    }
+    printf("\n");
+    for (int b = 0; b < NB_BUCKETS; ++b)
+    {
+        if (counts[b])
+        {
+            printf("  %9.3f - %9.3f ms %10llu\n", (1ULL << b) / 1000.0, (2ULL << b) / 1000.0,
+                    (unsigned long long)counts[b]);
+        }
+    }
+    fflush(stdout);
+}
+
+static void usage()
+{
+    fprintf(stderr, "usage: fleetsim [-n units] [-x speedup] [-d seconds] [-a steady|burst|random] [-r ramp_sec]"
+                    " [-k keepalive|close] [-m max_time_between_reports] [-P path] [-t threads] [-i stats_sec]"
+                    " host port\n");
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    int opt;
+    struct addrinfo hints, *res;
+    pthread_t *threads;
+    uint64_t last_requests = 0;
+
+    while ( (opt = getopt(argc, argv, "n:x:d:a:r:k:m:P:t:i:")) != -1)
+    {
+        switch (opt)
+        {
+          case 'n': nb_units = atoi(optarg); break;
+          case 'x': speedup = atof(optarg); break;
+          case 'd': duration_sec = atoi(optarg); break;
+          case 'a':
+            arrival = !strcmp(optarg, "burst") ? ARRIVE_BURST : !strcmp(optarg, "random") ? ARRIVE_RANDOM
+                    : ARRIVE_STEADY;
+            break;
+          case 'r': ramp_sec = atoi(optarg); break;
+          case 'k': keepalive = strcmp(optarg, "close") != 0; break;
+          case 'm': max_time_between_reports = atoi(optarg); break;
+          case 'P': report_path = optarg; break;
+          case 't': nb_threads = atoi(optarg); break;
+          case 'i': stats_sec = atoi(optarg); break;
+          default: usage();
+        }
+    }
+    if (argc - optind != 2 || nb_units <= 0 || nb_threads <= 0 || speedup <= 0)
+    {
+        usage();
+    }
+    server_host = argv[optind];
+    memset(&hints, 0, sizeof hints);
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(server_host, argv[optind+1], &hints, &res))
+    {
+        fprintf(stderr, "can't resolve %s\n", server_host);
+        return 1;
+    }
+    memcpy(&server_addr, res->ai_addr, sizeof server_addr);
+    freeaddrinfo(res);
+    signal(SIGPIPE, SIG_IGN);
+
+    srand(1);
+    units = (UNIT*)malloc(nb_units * sizeof *units);
+    for (int i = 0; i < nb_units; ++i)
+    {
+        initUnit(&units[i], i);
+    }
+    if (nb_threads > nb_units)
+    {
+        nb_threads = nb_units;
+    }
+    threads = (pthread_t*)malloc(nb_threads * sizeof *threads);
+    start_us = nowUs();
+    for (int i = 0; i < nb_threads; ++i)
+    {
+        THREAD *t = (THREAD*)calloc(1, sizeof *t);
+        t->epoll_fd = epoll_create1(0);
+        t->first_unit = (long)nb_units * i / nb_threads;
+        t->nb_units = (long)nb_units * (i + 1) / nb_threads - t->first_unit;
+        pthread_create(&threads[i], 0, runThread, t);
+    }
+    for (int elapsed = stats_sec; elapsed < duration_sec; elapsed += stats_sec)
+    {
+        sleep(stats_sec);
+        uint64_t requests = nb_requests;
+        char title[32];
+        snprintf(title, sizeof title, "%d s", elapsed);
+        printStats(title, stats_sec, requests - last_requests);
+        last_requests = requests;
+    }
+    for (int i = 0; i < nb_threads; ++i)
+    {
+        pthread_join(threads[i], 0);
+    }
+    printStats("total", (nowUs() - start_us) / 1e6, nb_requests);
+    return 0;
+}
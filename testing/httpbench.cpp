@@ -0,0 +1,130 @@
+/* Licensed under GNU General Public License v3.0
+  See https://github.com/jeffasuk/thermostat
+  jeff at jamcupboard.co.uk
+*/
+/* Throughput benchmark for httpparser.cpp. Built by mkHttpTests.
+   Parses a settings response of name=value lines, with Content-Length and with chunked transfer coding,
+   handed over in TCP-segment-sized pieces (as ESPAsyncTCP delivers them), and reports MB/s.
+        httpbench [nb_lines [piece_size]]
+   The host is far faster than an ESP8266, so compare the numbers between versions of the parser
+   rather than reading them as the device's speed.
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "httpparser.h"
+
+static long nb_body_lines;
+static long nb_headers;
+
+static void onHeader(void *, char *, char *)
+{
+    ++nb_headers;
+}
+
+static void onBodyLine(void *, char *line)
+{
+    // do what the thermostat does: split at '='
+    if (strchr(line, '='))
+    {
+        ++nb_body_lines;
+    }
+}
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static char *buildBody(int nb_lines, size_t *len)
+{
+    char *body = (char*)malloc(nb_lines * 64 + 1);
+    char *p = body;
+    for (int i = 0; i < nb_lines; ++i)
+    {
+        p += sprintf(p, "setting_number_%d=%d.%02d\r\n", i, i % 40, i % 100);
+    }
+    *len = p - body;
+    return body;
+}
+
+static char *buildResponse(const char *body, size_t body_len, int chunked, size_t *len)
+{
+    char *response = (char*)malloc(body_len * 2 + 512);
+    char *p = response;
+    p += sprintf(p, "HTTP/1.1 200 OK\r\nServer: bench\r\nETag: \"12345\"\r\nContent-Type: text/plain\r\n");
+    if (!chunked)
+    {
+        p += sprintf(p, "Content-Length: %u\r\n\r\n", (unsigned)body_len);
+        memcpy(p, body, body_len);
+        p += body_len;
+    }
+    else
+    {
+        size_t pos = 0;
+        p += sprintf(p, "Transfer-Encoding: chunked\r\n\r\n");
+        while (pos < body_len)
+        {
+            size_t n = body_len - pos < 500 ? body_len - pos : 500;    // chunk boundaries fall mid-line
+            p += sprintf(p, "%x\r\n", (unsigned)n);
+            memcpy(p, body + pos, n);
+            p += n;
+            p += sprintf(p, "\r\n");
+            pos += n;
+        }
+        p += sprintf(p, "0\r\n\r\n");
+    }
+    *len = p - response;
+    return response;
+}
+
+static void bench(const char *name, const char *response, size_t len, size_t piece_size, int nb_lines)
+{
+    HTTP_PARSER parser;
+    long runs = 0;
+    double start = now(), elapsed;
+    do
+    {
+        size_t pos = 0;
+        enum HTTP_PARSE_RESULT result = HTTP_MORE;
+        nb_body_lines = nb_headers = 0;
+        httpParserInit(&parser, onHeader, onBodyLine, 0);
+        while (pos < len && result == HTTP_MORE)
+        {
+            size_t n = len - pos < piece_size ? len - pos : piece_size;
+            result = httpParserFeed(&parser, response + pos, n);
+            pos += n;
+        }
+        if (result != HTTP_DONE || nb_body_lines != nb_lines)
+        {
+            fprintf(stderr, "%s: parse failed (result %d, %ld lines)\n", name, (int)result, nb_body_lines);
+            exit(1);
+        }
+        ++runs;
+    } while ( (elapsed = now() - start) < 1.0);
+    printf("%-16s %8u bytes  %8.1f MB/s  %6.2f ns/byte\n", name, (unsigned)len,
+            runs * len / elapsed / 1e6, elapsed * 1e9 / (runs * len));
+}
+
+int main(int argc, char **argv)
+{
+    int nb_lines = argc > 1 ? atoi(argv[1]) : 1000;
+    size_t piece_size = argc > 2 ? atoi(argv[2]) : 1460;
+    size_t body_len, len;
+    char *body = buildBody(nb_lines, &body_len);
+    char *response;
+
+    printf("%d lines, %u-byte pieces\n", nb_lines, (unsigned)piece_size);
+    response = buildResponse(body, body_len, 0, &len);
+    bench("content-length", response, len, piece_size, nb_lines);
+    free(response);
+    response = buildResponse(body, body_len, 1, &len);
+    bench("chunked", response, len, piece_size, nb_lines);
+    free(response);
+    free(body);
+    return 0;
+}
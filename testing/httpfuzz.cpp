@@ -0,0 +1,229 @@
+/* Licensed under GNU General Public License v3.0
+  See https://github.com/jeffasuk/thermostat
+  jeff at jamcupboard.co.uk
+*/
+/* Fuzz target for httpparser.cpp. Built by mkHttpTests.
+
+   Each input is parsed twice: in one piece, and split into random-sized pieces as a TCP connection might
+   deliver it. Both must give exactly the same callbacks and result, every line handed over must fit the
+   line buffer, and nothing may crash (build with -fsanitize=address,undefined to catch memory errors).
+
+   With libFuzzer (clang -fsanitize=fuzzer -DWITH_LIBFUZZER) the fuzzer drives it.
+   Otherwise main() runs the given files, or with no files, mutates some sample responses itself:
+        httpfuzz [-n iterations] [file...]
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "httpparser.h"
+
+// Record the callbacks as a hash, so the two runs can be compared cheaply
+static uint64_t trace_hash;
+
+static void traceBytes(const char *p, size_t len)
+{
+    for (; len; --len, ++p)
+    {
+        trace_hash = (trace_hash ^ (unsigned char)*p) * 0x100000001b3ULL;
+    }
+}
+
+static void checkLine(const char *what, const char *s)
+{
+    if (strlen(s) >= HTTP_LINE_SIZE)
+    {
+        fprintf(stderr, "%s longer than the line buffer\n", what);
+        abort();
+    }
+}
+
+static void onHeader(void *, char *name, char *value)
+{
+    checkLine("header name", name);
+    checkLine("header value", value);
+    traceBytes("H", 1);
+    traceBytes(name, strlen(name) + 1);
+    traceBytes(value, strlen(value) + 1);
+}
+
+static void onBodyLine(void *, char *line)
+{
+    checkLine("body line", line);
+    if (strchr(line, '\n'))
+    {
+        fprintf(stderr, "line end left in body line\n");
+        abort();
+    }
+    traceBytes("B", 1);
+    traceBytes(line, strlen(line) + 1);
+}
+
+static void traceResult(HTTP_PARSER *parser, enum HTTP_PARSE_RESULT result)
+{
+    char summary[64];
+    int len = snprintf(summary, sizeof summary, "R%d S%d C%d L%u", (int)result, parser->status, parser->close,
+                        (unsigned)parser->long_lines);
+    traceBytes(summary, len);
+}
+
+static size_t min(size_t a, size_t b)
+{
+    return a < b ? a : b;
+}
+
+// Parse the whole response, handed over in pieces no bigger than max_piece (0 = all at once)
+static uint64_t parse(const uint8_t *data, size_t size, size_t max_piece, uint32_t seed)
+{
+    HTTP_PARSER parser;
+    enum HTTP_PARSE_RESULT result = HTTP_MORE;
+    size_t pos = 0;
+
+    trace_hash = 0xcbf29ce484222325ULL;
+    httpParserInit(&parser, onHeader, onBodyLine, 0);
+    while (pos < size && result == HTTP_MORE)
+    {
+        size_t n = size - pos;
+        if (max_piece)
+        {
+            seed = seed * 1103515245 + 12345;
+            n = min(n, 1 + (seed >> 16) % max_piece);
+        }
+        result = httpParserFeed(&parser, (const char*)data + pos, n);
+        pos += n;
+    }
+    if (result == HTTP_MORE)
+    {
+        result = httpParserEof(&parser);
+    }
+    if (result == HTTP_MORE)
+    {
+        fprintf(stderr, "parser still wants more after the connection closed\n");
+        abort();
+    }
+    traceResult(&parser, result);
+    return trace_hash;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    uint64_t whole = parse(data, size, 0, 0);
+    uint32_t seed = size;
+    size_t max_piece;
+    for (max_piece = 1; max_piece <= 64; max_piece *= 4)
+    {
+        if (parse(data, size, max_piece, seed++) != whole)
+        {
+            fprintf(stderr, "different result when split into pieces of up to %u bytes\n", (unsigned)max_piece);
+            abort();
+        }
+    }
+    return 0;
+}
+
+#ifndef WITH_LIBFUZZER
+
+static const char *samples[] = {
+    "HTTP/1.1 200 OK\r\nContent-Length: 41\r\nETag: \"abc\"\r\n\r\ndesired_temperature=19.5\r\nprecision=0.2\r\n",
+    "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+        "7\r\nmode=1\n\r\n1a;ext=1\r\ndesired_temperature=21.0\nx\r\n0\r\nTrailer: x\r\n\r\n",
+    "HTTP/1.0 200 OK\r\n\r\nport=8080\nrpthost=example.com\nno terminator",
+    "HTTP/1.1 304 Not Modified\r\nETag: \"abc\"\r\n\r\n",
+    "HTTP/1.1 100 Continue\r\n\r\nHTTP/1.1 204 No Content\r\nConnection: close\r\n\r\n",
+    "HTTP/1.1 404\r\nContent-Length: 0\r\n\r\n",
+    "garbage\r\n\r\n",
+};
+
+static size_t mutate(uint8_t *buf, size_t len, size_t max_len)
+{
+    int nb_changes = 1 + rand() % 8;
+    while (nb_changes--)
+    {
+        size_t pos = len ? rand() % len : 0;
+        switch (rand() % 5)
+        {
+          case 0:   // flip a byte
+            if (len)
+            {
+                buf[pos] = rand();
+            }
+            break;
+          case 1:   // delete a run
+            if (len)
+            {
+                size_t n = min(len - pos, 1 + rand() % 16);
+                memmove(buf + pos, buf + pos + n, len - pos - n);
+                len -= n;
+            }
+            break;
+          case 2:   // duplicate a run, which can make very long lines
+            if (len)
+            {
+                size_t n = min(len - pos, 1 + rand() % 200);
+                if (len + n <= max_len)
+                {
+                    memmove(buf + pos + n, buf + pos, len - pos);
+                    len += n;
+                }
+            }
+            break;
+          case 3:   // insert an interesting character
+            if (len < max_len)
+            {
+                static const char interesting[] = "\r\n:= 0f;";
+                memmove(buf + pos + 1, buf + pos, len - pos);
+                buf[pos] = interesting[rand() % (sizeof interesting - 1)];
+                ++len;
+            }
+            break;
+          case 4:   // truncate
+            len = pos;
+            break;
+        }
+    }
+    return len;
+}
+
+int main(int argc, char **argv)
+{
+    static uint8_t buf[16384];
+    long iterations = 200000;
+    int argi = 1;
+
+    if (argc > 2 && !strcmp(argv[1], "-n"))
+    {
+        iterations = atol(argv[2]);
+        argi = 3;
+    }
+    if (argi < argc)
+    {
+        for (; argi < argc; ++argi)
+        {
+            FILE *inf = fopen(argv[argi], "rb");
+            size_t len;
+            if (!inf)
+            {
+                perror(argv[argi]);
+                return 1;
+            }
+            len = fread(buf, 1, sizeof buf, inf);
+            fclose(inf);
+            LLVMFuzzerTestOneInput(buf, len);
+        }
+        return 0;
+    }
+
+    srand(1);
+    for (long i = 0; i < iterations; ++i)
+    {
+        const char *sample = samples[i % (sizeof samples / sizeof samples[0])];
+        size_t len = strlen(sample);
+        memcpy(buf, sample, len);
+        len = mutate(buf, len, sizeof buf);
+        LLVMFuzzerTestOneInput(buf, len);
+    }
+    printf("%ld inputs OK\n", iterations);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,227 @@
+/* Licensed under GNU General Public License v3.0
+  See https://github.com/jeffasuk/thermostat
+  jeff at jamcupboard.co.uk
+*/
+/* Benchmark for the /status renderer (../statusformat.cpp), against a copy of the old String-concatenating
+   version, with std::string standing in for Arduino's String.
+   Reports the time per render and the number of heap allocations per render, which is the figure that
+   matters on the ESP8266: each one costs time and helps fragment a heap of a few tens of kB.
+   The JSON delta is what gets pushed to /events.
+   Also checks that the new XML is byte for byte the same as the old.
+        g++ -O2 -I.. -o /tmp/statusbench statusbench.cpp ../statusformat.cpp ../utils.cpp
+        /tmp/statusbench [nb_sensors]
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include <new>
+#include "statusformat.h"
+#include "utils.h"
+
+// count every allocation by replacing malloc (glibc lets us reach the real one as __libc_malloc)
+extern "C" void *__libc_malloc(size_t size);
+static long nb_allocs;
+
+extern "C" void *malloc(size_t size)
+{
+    ++nb_allocs;
+    return __libc_malloc(size);
+}
+
+void *operator new(size_t size)
+{
+    void *p = malloc(size ? size : 1);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+// as String(float): two decimal places
+static std::string String(float f)
+{
+    char buf[20];
+    snprintf(buf, sizeof buf, "%.2f", f);
+    return buf;
+}
+
+static std::string String(int n)
+{
+    return std::to_string(n);
+}
+
+static std::string String(uint32_t n)
+{
+    return std::to_string(n);
+}
+
+static std::string String(const char *s)
+{
+    return s;
+}
+
+// the renderer as it was, with the globals it read replaced by the snapshot, and <boot> added since
+static std::string renderStatusWithString(const STATUS_DATA *status)
+{
+    int sensor_index;
+    char addr_buf[17];
+    std::string response = String("<status>\n");
+    for (sensor_index = 0; sensor_index < status->nb_sensors; ++ sensor_index)
+    {
+        response += String(" <tmp id=\"") +
+            String(formatAddr(addr_buf, (unsigned char*)status->sensor_addr[sensor_index])) +
+            String("\">") +
+            String(status->sensor_temperature[sensor_index]) +
+            String("</tmp>\n");
+    }
+    response += String(" <state>") + String((int)status->power_state) + String("</state>\n") +
+                String(" <main>") + String((int)status->main_state) + String("</main>\n") +
+            String(" <des>")   + String(status->desired_temperature) + String("</des>\n") +
+            String(" <prec>")   + String(status->precision) + String("</prec>\n") +
+            String(" <switchoffsetabove>")   + String(status->switch_offset_above) + String("</switchoffsetabove>\n") +
+            String(" <switchoffsetbelow>")   + String(status->switch_offset_below) + String("</switchoffsetbelow>\n") +
+            String(" <mode>")   + String(status->heating ? "heating" : "cooling") + String("</mode>\n") +
+            String(" <runon>") + String(status->fan_overrun_sec) + String("</runon>\n") +
+            String(" <maxrep>")   + String(status->max_time_between_reports) + String("</maxrep>\n") +
+            String(" <boot><fast>") + String((uint32_t)status->boot.fast) + String("</fast><setup>") +
+                String(status->boot.setup) + String("</setup><settings>") + String(status->boot.settings) +
+                String("</settings><reading>") + String(status->boot.reading) + String("</reading><decision>") +
+                String(status->boot.decision) + String("</decision><wifi>") + String(status->boot.wifi) +
+                String("</wifi></boot>\n") +
+        String("</status>\n");
+    return response;
+}
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void fillStatus(STATUS_DATA *status, int nb_sensors)
+{
+    memset(status, 0, sizeof *status);
+    status->nb_sensors = nb_sensors;
+    for (int i = 0; i < nb_sensors; ++i)
+    {
+        for (int j = 0; j < 8; ++j)
+        {
+            status->sensor_addr[i][j] = 0x28 + i * 8 + j;
+        }
+        status->sensor_temperature[i] = 19.5f + i * 0.37f;
+    }
+    status->sensor_temperature[0] = -0.5f;
+    if (nb_sensors > 1)
+    {
+        status->sensor_temperature[nb_sensors - 1] = -999999.0f;   // IMPOSSIBLE_TEMPERATURE
+    }
+    status->power_state = 1;
+    status->main_state = 0;
+    status->heating = 1;
+    status->desired_temperature = 20.25f;
+    status->precision = 0.3f;
+    status->switch_offset_above = 0.15f;
+    status->switch_offset_below = -0.07f;
+    status->fan_overrun_sec = 120;
+    status->max_time_between_reports = 600;
+    status->boot.fast = 1;
+    status->boot.setup = 61;
+    status->boot.settings = 94;
+    status->boot.reading = 871;
+    status->boot.decision = 872;
+    status->boot.wifi = 2315;
+}
+
+typedef size_t (*RENDER_FN)(const STATUS_DATA *status, char *buf, size_t size);
+
+static size_t renderOld(const STATUS_DATA *status, char *buf, size_t size)
+{
+    std::string s = renderStatusWithString(status);
+    size_t len = s.size() < size ? s.size() : size;
+    memcpy(buf, s.data(), len);
+    return len;
+}
+
+static size_t renderXml(const STATUS_DATA *status, char *buf, size_t size)
+{
+    return formatStatusXml(buf, buf + size, status) - buf;
+}
+
+static size_t renderJson(const STATUS_DATA *status, char *buf, size_t size)
+{
+    return formatStatusJson(buf, buf + size, status) - buf;
+}
+
+// the push to /events when one reading has changed
+static STATUS_DATA previous_status;
+static size_t renderDelta(const STATUS_DATA *status, char *buf, size_t size)
+{
+    size_t len = formatStatusDeltaJson(buf, buf + size, &previous_status, status) - buf;
+    previous_status = *status;
+    return len;
+}
+
+static void bench(const char *name, RENDER_FN render, STATUS_DATA *status)
+{
+    char buf[1024];
+    long runs = 0, allocs_before = nb_allocs;
+    size_t len = 0;
+    double start = now(), elapsed;
+    do
+    {
+        status->sensor_temperature[0] += 0.01f;     // as if a new reading had come in
+        len = render(status, buf, sizeof buf);
+        ++runs;
+    } while ( (elapsed = now() - start) < 1.0);
+    printf("%-12s %5u bytes  %8.0f ns/render  %6.1f allocs/render\n", name, (unsigned)len,
+            elapsed * 1e9 / runs, (double)(nb_allocs - allocs_before) / runs);
+}
+
+int main(int argc, char **argv)
+{
+    int nb_sensors = argc > 1 ? atoi(argv[1]) : 3;
+    STATUS_DATA status;
+    char buf[1024];
+    size_t len;
+
+    if (nb_sensors < 0 || nb_sensors > STATUS_MAX_SENSORS)
+    {
+        fprintf(stderr, "nb_sensors must be 0 to %d\n", STATUS_MAX_SENSORS);
+        return 1;
+    }
+    fillStatus(&status, nb_sensors);
+    std::string old_xml = renderStatusWithString(&status);
+    len = renderXml(&status, buf, sizeof buf);
+    if (len != old_xml.size() || memcmp(buf, old_xml.data(), len))
+    {
+        fprintf(stderr, "XML differs from the String version:\n%s---\n%.*s", old_xml.c_str(), (int)len, buf);
+        return 1;
+    }
+    len = renderJson(&status, buf, sizeof buf);
+    printf("%.*s", (int)len, buf);
+    previous_status = status;
+    previous_status.power_state = 0;
+    len = renderDelta(&status, buf, sizeof buf);
+    printf("%.*s\n", (int)len, buf);
+    printf("%d sensors\n", nb_sensors);
+    bench("String xml", renderOld, &status);
+    bench("xml", renderXml, &status);
+    bench("json", renderJson, &status);
+    bench("json delta", renderDelta, &status);
+    return 0;
+}
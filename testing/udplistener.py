@@ -0,0 +1,56 @@
+#!/usr/bin/python3
+# Licensed under GNU General Public License v3.0
+# See https://github.com/jeffasuk/thermostat
+# jeff at jamcupboard.co.uk
+'''UDP report listener, for testing the thermostat's UDP report mode (udp_port setting).
+Print each datagram, note gaps in the sequence numbers, and send an acknowledgement
+("ack=<highest seq>&lost=<nb missing since last ack>") to each unit every ACK_EVERY datagrams.
+
+Usage: udplistener.py [port]
+Then point the thermostat's rpthost at this machine and set udp_port to the same port.
+Text (query string) datagrams are printed as they are; binary ones are shown in hex.
+'''
+
+import socket
+import sys
+
+ACK_EVERY = 10
+
+port = int(sys.argv[1]) if len(sys.argv) > 1 else 5005
+sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+sock.bind(('', port))
+print(f'Listening on UDP port {port}')
+
+units = {}  # address -> [highest seq, lost since last ack, received since last ack]
+
+
+def read_varint(data):
+    n = shift = 0
+    for b in data:
+        n |= (b & 0x7f) << shift
+        shift += 7
+        if not b & 0x80:
+            break
+    return n
+
+
+while True:
+    data, addr = sock.recvfrom(2048)
+    if data.startswith(b'seq='):
+        seq = int(data[4:data.index(b'&')])
+        shown = data.decode('latin-1')
+    else:
+        seq = read_varint(data)
+        shown = data.hex()
+    unit = units.setdefault(addr, [seq - 1, 0, 0])
+    if seq <= unit[0]:
+        print(f'{addr}: sequence restarted at {seq} (unit reset?)')
+    elif seq > unit[0] + 1:
+        print(f'{addr}: missing {seq - unit[0] - 1} before {seq}')
+        unit[1] += seq - unit[0] - 1
+    unit[0] = seq
+    unit[2] += 1
+    print(f'{addr} {seq}: {shown}')
+    if unit[2] >= ACK_EVERY:
+        sock.sendto(f'ack={unit[0]}&lost={unit[1]}'.encode(), addr)
+        unit[1] = unit[2] = 0
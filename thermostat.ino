@@ -5,10 +5,15 @@
 
 #include <ESP8266WiFi.h>
 #include "globals.h"
+#include "compression.h"
+#include "history.h"
 #include "led.h"
 #include "network.h"
 #include "eepromutils.h"
+#include "settingsjournal.h"
 #include "sensors.h"
+#include "settingsqueue.h"
+#include "telemetry.h"
 #include "webserver.h"
 
 /* NB The terms "up" and "down" refer to the direction in which the power operates, so "up" means
@@ -41,6 +46,8 @@ typedef enum REGION {REGION_HIGH, REGION_MID_HIGH, REGION_MID_LOW, REGION_LOW};
 
 static uint32_t     millis_now;
 static uint32_t     millis_at_last_report = 0;
+static REPORT_SAMPLE compression_candidate;     // this tick's values, reported on a later tick if the swinging door says so
+static uint8_t      have_compression_candidate = 0;
 static float        previous_temperature = IMPOSSIBLE_TEMPERATURE;     // for detecting direction of change
 static uint32_t     switch_fans_off_at;
 
@@ -153,13 +160,13 @@ static void assessPerformance()
     // ignore the most extreme min and max values, to filter out extreme events.
     average_discrepancy -= min_val + max_val;
     average_discrepancy /= HISTORY_LENGTH - 2;
-    DOPRINT("average discrepancy over ");
+    DOPRINT(F("average discrepancy over "));
     DOPRINT(HISTORY_LENGTH);
-    DOPRINT(" peaks/troughs: ");
+    DOPRINT(F(" peaks/troughs: "));
     DOPRINT(average_discrepancy);
-    DOPRINT(" Ignoring extreme values ");
+    DOPRINT(F(" Ignoring extreme values "));
     DOPRINT(min_val);
-    DOPRINT(" and ");
+    DOPRINT(F(" and "));
     DOPRINTLN(max_val);
     // adjust switch offsets
     float relative_switch_temperature = (switch_offset_above + switch_offset_below) / 2;
@@ -260,7 +267,7 @@ static float local_previous_temperature = IMPOSSIBLE_TEMPERATURE;    // NB: sepa
         if (region == REGION_HIGH)
         {
             // above the upper temperature; always turn off
-            DOPRINTLN("High: switch OFF");
+            DOPRINTLN(F("High: switch OFF"));
             do_switch = 1;
         }
         else
@@ -278,11 +285,11 @@ static float local_previous_temperature = IMPOSSIBLE_TEMPERATURE;    // NB: sepa
                         {
                             if ( region == REGION_MID_HIGH)
                             {
-                                DOPRINTLN("Mid-high and heating more powerful: switch OFF");
+                                DOPRINTLN(F("Mid-high and heating more powerful: switch OFF"));
                             }
                             else
                             {
-                                DOPRINTLN("Mid-low and heating more powerful and temp rising: switch OFF");
+                                DOPRINTLN(F("Mid-low and heating more powerful and temp rising: switch OFF"));
                             }
                             do_switch = 1;
                         }
@@ -296,7 +303,7 @@ static float local_previous_temperature = IMPOSSIBLE_TEMPERATURE;    // NB: sepa
                         // High has already been dealt with above
                         if ( region == REGION_MID_HIGH && norm_changing > 0)
                         {
-                            DOPRINTLN("Mid-high and heating less powerful and temp rising: switch OFF");
+                            DOPRINTLN(F("Mid-high and heating less powerful and temp rising: switch OFF"));
                             do_switch = 1;
                         }
                     }
@@ -308,7 +315,7 @@ static float local_previous_temperature = IMPOSSIBLE_TEMPERATURE;    // NB: sepa
                         if ( (region == REGION_MID_HIGH || region == REGION_MID_LOW)
                                 && norm_changing > 0)
                         {
-                            DOPRINTLN("Balanced: switch OFF");
+                            DOPRINTLN(F("Balanced: switch OFF"));
                             do_switch = 1;
                         }
                     }
@@ -331,7 +338,7 @@ static float local_previous_temperature = IMPOSSIBLE_TEMPERATURE;    // NB: sepa
         if (region == REGION_LOW)
         {
             // below the lower temperature; always turn on
-            DOPRINTLN("Low: switch ON");
+            DOPRINTLN(F("Low: switch ON"));
             do_switch = 1;
         }
         else
@@ -345,7 +352,7 @@ static float local_previous_temperature = IMPOSSIBLE_TEMPERATURE;    // NB: sepa
                         // Low has already been dealt with above
                         if ( region == REGION_MID_LOW && norm_changing < 0)
                         {
-                            DOPRINTLN("Mid-low and heating more powerful and temp falling: switch ON");
+                            DOPRINTLN(F("Mid-low and heating more powerful and temp falling: switch ON"));
                             do_switch = 1;
                         }
                     }
@@ -360,11 +367,11 @@ static float local_previous_temperature = IMPOSSIBLE_TEMPERATURE;    // NB: sepa
                         {
                             if ( region == REGION_MID_LOW)
                             {
-                                DOPRINTLN("Mid-low and heating less powerful: switch ON");
+                                DOPRINTLN(F("Mid-low and heating less powerful: switch ON"));
                             }
                             else
                             {
-                                DOPRINTLN("Mid-low and heating less powerful and temp falling: switch ON");
+                                DOPRINTLN(F("Mid-low and heating less powerful and temp falling: switch ON"));
                             }
                             do_switch = 1;
                         }
@@ -377,7 +384,7 @@ static float local_previous_temperature = IMPOSSIBLE_TEMPERATURE;    // NB: sepa
                         if ( (region == REGION_MID_HIGH || region == REGION_MID_LOW)
                                 && norm_changing < 0)
                         {
-                            DOPRINTLN("Balanced: switch ON");
+                            DOPRINTLN(F("Balanced: switch ON"));
                             do_switch = 1;
                         }
                     }
@@ -411,7 +418,7 @@ static float local_previous_temperature = IMPOSSIBLE_TEMPERATURE;    // NB: sepa
     {
         switch_offset_below = pending_switch_offset_below;
         pending_switch_offset_below = IMPOSSIBLE_TEMPERATURE;
-        DOPRINT("Apply pending switch-offset-below: ");
+        DOPRINT(F("Apply pending switch-offset-below: "));
         DOPRINTLN(switch_offset_below);
     }
 
@@ -419,7 +426,7 @@ static float local_previous_temperature = IMPOSSIBLE_TEMPERATURE;    // NB: sepa
     {
         switch_offset_above = pending_switch_offset_above;
         pending_switch_offset_above = IMPOSSIBLE_TEMPERATURE;
-        DOPRINT("Apply pending switch-offset-above: ");
+        DOPRINT(F("Apply pending switch-offset-above: "));
         DOPRINTLN(switch_offset_above);
     }
 
@@ -428,15 +435,25 @@ static float local_previous_temperature = IMPOSSIBLE_TEMPERATURE;    // NB: sepa
 
 
 
-/* this is called on power-up */
+/* this is called on power-up
+
+   With fast_boot set (the default), nothing here waits: settings are loaded, WiFi is started in the
+   background (see startWiFi()), and loop() reads the sensor and sets the relays on its first tick.
+   The relays are off until then. Without it, start-up is as it always was: three seconds of sleeps,
+   then up to 30 seconds connecting to WiFi, all before the first reading.
+   How long each stage took is in /status (see BOOT_TIMES).
+*/
 void setup()
 {                
     int do_setup_mode = 0;
+    NOTE_BOOT_TIME(setup);
 #ifndef QUIET
+    // There used to be a delay(100) here, for USB-serial bridges that need a moment after this. It can't
+    // depend on fast_boot, which isn't known until the settings are loaded, so it's gone for both, and
+    // the first few lines of output may be missed on such a bridge.
     Serial.begin(115200);
 #endif
-    delay(100);
-    DOPRINTLN("");
+    DOPRINTLN(F(""));
     DOPRINTLN(sizeof persistent_data);
     DOPRINTLN((uint32_t)&(persistent_data.port));
     DOPRINTLN((uint32_t)&(persistent_data.max_time_between_reports));
@@ -448,46 +465,56 @@ void setup()
     pinMode(LED_PIN, OUTPUT);     
     pinMode(RELAY_PIN_MAIN, OUTPUT);     
     pinMode(RELAY_PIN_POWER, OUTPUT);     
-    DOPRINTLN("Sleep 1");
-    delay(1000);
-    if (eepromIsUninitialized())
+    if (!loadSettings())
     {
         do_setup_mode = 1;
-        DOPRINT("No valid data in EEPROM.");
+        DOPRINT(F("No saved settings."));
     }
     else
     {
-        DOPRINTLN("Reading settings from EEPROM");
-        readFromEeprom();
 #ifndef QUIET
         showSettings();
 #endif
     }
+    NOTE_BOOT_TIME(settings);
+    if (!persistent_data.fast_boot)
+    {
+        DOPRINTLN(F("Sleep 1"));
+        delay(1000);
+    }
     if (!do_setup_mode && digitalRead(SETUP_PIN) == LOW)
     {
         do_setup_mode = 1;
-        DOPRINT("Set-up signal found.");
+        DOPRINT(F("Set-up signal found."));
+    }
+    if (!persistent_data.fast_boot)
+    {
+        // sleep a little in software while hardware wakes up
+        DOPRINTLN(F("Sleep 2"));
+        delay(2000);
     }
-    // sleep a little in software while hardware wakes up
-    DOPRINTLN("Sleep 2");
-    delay(2000);
     if (do_setup_mode)
     {
-        DOPRINTLN(" Entering set-up mode.");
+        DOPRINTLN(F(" Entering set-up mode."));
         startAccessPoint();
         IPAddress myIP = WiFi.softAPIP();
-        DOPRINT("AP IP address: ");
+        DOPRINT(F("AP IP address: "));
         DOPRINTLN(myIP);
         setLEDflashing(800, 200);
         in_setup_mode = 1;
     }
+    else if (persistent_data.fast_boot)
+    {
+        startWiFi();    // serviceWiFi() in loop() does the rest
+    }
     else
     {
         WiFi.mode(WIFI_STA);    // Don't need AP now
         connectWiFi();
-        DOPRINT("IP address: ");
+        DOPRINT(F("IP address: "));
         DOPRINTLN(WiFi.localIP());
     }
+    startTelemetry();
     startAsyncWebServer();  // need a webserver in all modes
 }
 
@@ -499,6 +526,8 @@ void loop()
     static int8_t main_state_before_safety_switch_off = 0;
     setLED();   // allow operation of whatever flash/pulse mode has been set
 
+    serviceSave();
+
     if (in_setup_mode)
     {
         delay(10);    // Nothing to do in loop() until setup has been done in the async webserver
@@ -509,34 +538,39 @@ void loop()
     if (WiFi.getMode() == WIFI_AP_STA)
     {
         // switching to normal mode
-        DOPRINTLN(" Leaving set-up mode.");
+        DOPRINTLN(F(" Leaving set-up mode."));
         WiFi.mode(WIFI_STA);    // Don't need AP now
         connectWiFi();
     }
 
     uint32_t millis_at_loop_start = millis();
 
+    applyQueuedSettings();  // changes from the web page and the server, made here where nothing is using the values
+    serviceWiFi();
+    serviceReports();   // never blocks; reports are sent in the background
+
     setLEDflashing(100, 400);
     readSensors(&sensor_data);
     if (sensor_data.temperature[0].ok != ONEWIRE_OK)
     {
         if (safety_switch_off)
         {
-            DOPRINTLN("Failed to read controlling temperature sensor. Continuing off for safety.");
+            DOPRINTLN(F("Failed to read controlling temperature sensor. Continuing off for safety."));
         }
         else
         {
-            DOPRINTLN("Failed to read controlling temperature sensor. Turning off for safety.");
+            DOPRINTLN(F("Failed to read controlling temperature sensor. Turning off for safety."));
             power_state_before_safety_switch_off = power_state;
             main_state_before_safety_switch_off = main_state;
             setLEDflashing(500, 500);
             safety_switch_off = 1;
             sendReport(previous_temperature, POWER_OFF, POWER_OFF, switch_offset_below, switch_offset_above,
-                        "Turning off for safety.", &sensor_data);
+                        "Turning off for safety.", &sensor_data, 1);
         }
         power_state = main_state = POWER_OFF;
         digitalWrite(RELAY_PIN_POWER, 0);
         digitalWrite(RELAY_PIN_MAIN, 0);
+        NOTE_BOOT_TIME(decision);
     }
     else
     {
@@ -559,36 +593,37 @@ void loop()
             safety_switch_off = 0;
             strcat(report_text, "Safety switch-off ended. ");
         }
+        NOTE_BOOT_TIME(reading);
         temperature_to_report = current_temperature = sensor_data.temperature[0].temperature_c;
 #ifndef QUIET
         DOPRINT  (powerStateName[power_state]);
-        DOPRINT  (" at ");
+        DOPRINT  (F(" at "));
         DOPRINT  (current_temperature);
-        DOPRINT  ("deg ");
+        DOPRINT  (F("deg "));
         switch(temperature_changing)
         {
             case 0:
                 {
-                    DOPRINT  ("change less than ");
+                    DOPRINT  (F("change less than "));
                     DOPRINT  (persistent_data.precision);
                 }
                 break;
             case 1:
             case -1:
                 {
-                    DOPRINT  ("getting ");
+                    DOPRINT  (F("getting "));
                     DOPRINT  ((temperature_changing < 0) ? "cooler by " : "warmer by ");
                     DOPRINT  (abs(previous_temperature - current_temperature));
                 }
                 break;
         }
-        DOPRINT  (", target ");
+        DOPRINT  (F(", target "));
         DOPRINT  (persistent_data.desired_temperature);
-        DOPRINT  ("   switching range ");
+        DOPRINT  (F("   switching range "));
         DOPRINT  (switch_offset_below);
-        DOPRINT  (" .. ");
+        DOPRINT  (F(" .. "));
         DOPRINT  (switch_offset_above);
-        DOPRINT  ("  for ");
+        DOPRINT  (F("  for "));
         DOPRINTLN(persistent_data.mode == HEATING ? "heating" : "cooling");
 #endif
 
@@ -597,7 +632,7 @@ void loop()
         if (power_state == POWER_OFF && main_state == POWER_ON && millis_now >= switch_fans_off_at)
         {
             // fan overrun time expired, so switch main off
-            DOPRINTLN("Switching fans off");
+            DOPRINTLN(F("Switching fans off"));
             strcat(report_text, "Switching fans off. ");
             main_state = POWER_OFF;
             digitalWrite(RELAY_PIN_MAIN, 0);
@@ -612,12 +647,12 @@ void loop()
             if (previous_temperature == IMPOSSIBLE_TEMPERATURE)
             {
                 strcat(report_text, "First time after reset. ");
-                DOPRINTLN("report because first time through");
+                DOPRINTLN(F("report because first time through"));
             }
             else
             {
                 strcat(report_text, "First time after change in settings");
-                DOPRINTLN("report because of change in settings");
+                DOPRINTLN(F("report because of change in settings"));
             }
             previous_desired_temperature = persistent_data.desired_temperature;
             previous_mode = persistent_data.mode;
@@ -655,7 +690,7 @@ void loop()
             if (change_name != NULL)
             {
                 // a reportable change has occurred
-                DOPRINT("report because now getting ");
+                DOPRINT(F("report because now getting "));
                 DOPRINTLN(change_name);
                 temperature_to_report = previous_temperature;   // report the more extreme, now that we're going in the opposite direction
             }
@@ -678,8 +713,8 @@ void loop()
                 if (power_state)
                 {
                     strcat(report_text, "Turning on");
-                    DOPRINTLN("report because turning on");
-                    DOPRINTLN("turn on");
+                    DOPRINTLN(F("report because turning on"));
+                    DOPRINTLN(F("turn on"));
                     power_state = main_state = POWER_ON;
                     digitalWrite(RELAY_PIN_MAIN, 1);
                     digitalWrite(RELAY_PIN_POWER, 1);
@@ -687,8 +722,8 @@ void loop()
                 else
                 {
                     strcat(report_text, "Turning off");
-                    DOPRINTLN("report because turning off");
-                    DOPRINTLN("turn off");
+                    DOPRINTLN(F("report because turning off"));
+                    DOPRINTLN(F("turn off"));
                     power_state = POWER_OFF;
                     digitalWrite(RELAY_PIN_POWER, 0);
                     if (persistent_data.fan_overrun_sec == 0)
@@ -703,8 +738,21 @@ void loop()
                     }
                 }
             }
+            NOTE_BOOT_TIME(decision);
         }
 
+        uint8_t is_event = report_text[0] != '\0';   // anything other than the periodic report
+        uint8_t compressing = persistent_data.compression_dev > 0;
+        if (!report_text[0] && compressing && have_compression_candidate
+                && swingingDoorCheck(millis_now, temperature_to_report, persistent_data.compression_dev))
+        {
+            // Can't get from the last reported point to this one without leaving the permitted error band,
+            // so the server needs the previous point.
+            DOPRINTLN(F("reporting previous point for compression"));
+            sendSample(&compression_candidate);
+            millis_at_last_report = compression_candidate.taken_at;
+        }
+        // when compressing, this is just the heartbeat ceiling
         if (!report_text[0]
                 && (millis_now - millis_at_last_report) > (persistent_data.max_time_between_reports * 1000))
         {
@@ -713,15 +761,25 @@ void loop()
         }
         if (report_text[0])
         {
-            DOPRINT  ("reporting because: ");
+            DOPRINT  (F("reporting because: "));
             DOPRINTLN(report_text);
             sendReport(temperature_to_report, power_state, main_state, switch_offset_below, switch_offset_above,
-                        report_text, &sensor_data);
+                        report_text, &sensor_data, is_event);
             millis_at_last_report = millis_now;
+            archiveCompressionPoint(millis_now, temperature_to_report);
+        }
+        if (compressing)
+        {
+            fillSample(&compression_candidate, temperature_to_report, power_state, main_state,
+                        switch_offset_below, switch_offset_above, "Compressed", &sensor_data, 0);
         }
+        have_compression_candidate = compressing;
 
         setLEDflashing(0, 0);
     }
+    addHistorySample(millis(), sensor_data.temperature[0].ok == ONEWIRE_OK,
+                     sensor_data.temperature[0].temperature_c, power_state == POWER_ON);
+    publishStatus();    // for the web page, which is served from this snapshot until the next tick
     // min 1-sec spacing between actions, allowing for how much time was spent actually doing stuff
     // always have a non-zero delay call to let other operations in (probably unnecessary, but no harm).
     delay(max(1, int(1000 - (millis() - millis_at_loop_start))));
@@ -2,6 +2,7 @@
   See https://github.com/jeffasuk/thermostat
   jeff at jamcupboard.co.uk
 */
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -38,3 +39,108 @@ char *formatAddr(char *buf, unsigned char  addr[8])
     *p = 0;
     return buf; // as for printff
 }
+
+/* Helpers for building text into a fixed-size buffer. Each appends what fits before 'end' and returns
+   the new end of the text. The text is not nul-terminated; callers use the returned pointer.
+   If the result == end, the buffer was (probably) too small.
+*/
+char *appendStr(char *p, char *end, const char *s)
+{
+    while (*s && p < end)
+    {
+        *p++ = *s++;
+    }
+    return p;
+}
+
+char *appendUint(char *p, char *end, uint32_t n)
+{
+    char buf[10];
+    int len = 0;
+    do
+    {
+        buf[len++] = '0' + n % 10;
+        n /= 10;
+    } while (n);
+    while (len && p < end)
+    {
+        *p++ = buf[--len];
+    }
+    return p;
+}
+
+char *appendInt(char *p, char *end, int32_t n)
+{
+    if (n < 0)
+    {
+        p = appendStr(p, end, "-");
+    }
+    return appendUint(p, end, n < 0 ? -(uint32_t)n : n);
+}
+
+// Two decimal places, as dtostrf(f, 1, 2) and String(f) give, but without sprintf or a float-formatting library.
+// The whole part is taken off first so that large values (IMPOSSIBLE_TEMPERATURE) keep their precision.
+// Exact halves (0.125) round up, and a value that rounds to zero has no minus sign.
+char *appendFloat(char *p, char *end, float f)
+{
+    uint8_t negative = f < 0;
+    float magnitude = negative ? -f : f;
+    uint32_t whole = (uint32_t)magnitude;
+    uint32_t centi = (uint32_t)((magnitude - whole) * 100 + 0.5f);
+    if (centi >= 100)
+    {
+        ++whole;
+        centi -= 100;
+    }
+    char fraction[] = {'.', (char)('0' + centi / 10), (char)('0' + centi % 10), 0};
+    if (negative && (whole || centi))
+    {
+        p = appendStr(p, end, "-");
+    }
+    p = appendUint(p, end, whole);
+    return appendStr(p, end, fraction);
+}
+
+// Binary equivalents, for the compact report formats. varint is unsigned LEB128; svarint is zigzag-encoded.
+char *appendByte(char *p, char *end, uint8_t b)
+{
+    if (p < end)
+    {
+        *p++ = b;
+    }
+    return p;
+}
+
+char *appendVarint(char *p, char *end, uint32_t n)
+{
+    while (n >= 0x80 && p < end)
+    {
+        *p++ = (n & 0x7f) | 0x80;
+        n >>= 7;
+    }
+    return appendByte(p, end, n);
+}
+
+char *appendSvarint(char *p, char *end, int32_t n)
+{
+    return appendVarint(p, end, ((uint32_t)n << 1) ^ (uint32_t)(n >> 31));
+}
+
+/* CRC-32 as used by zlib and Ethernet. Start with 0, and pass the result back in to carry on with more data.
+   Bitwise rather than table-driven: it's only used for settings records, so a 1K table isn't worth the space.
+*/
+uint32_t crc32Append(uint32_t crc, const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t*)data;
+    int i;
+    crc = ~crc;
+    while (len--)
+    {
+        crc ^= *p++;
+        for (i=0; i < 8; ++i)
+        {
+            crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
@@ -2,5 +2,16 @@
   See https://github.com/jeffasuk/thermostat
   jeff at jamcupboard.co.uk
 */
+#include <stdint.h>
+#include <stddef.h>
+
 extern char *printff(char *buf, float f);
 extern char *formatAddr(char *buf, unsigned char addr[8]);
+extern char *appendStr(char *p, char *end, const char *s);
+extern char *appendFloat(char *p, char *end, float f);
+extern char *appendUint(char *p, char *end, uint32_t n);
+extern char *appendInt(char *p, char *end, int32_t n);
+extern char *appendByte(char *p, char *end, uint8_t b);
+extern char *appendVarint(char *p, char *end, uint32_t n);
+extern char *appendSvarint(char *p, char *end, int32_t n);
+extern uint32_t crc32Append(uint32_t crc, const void *data, size_t len);
@@ -8,10 +8,14 @@
 #include <ESPAsyncWebSrv.h>
 
 #include "globals.h"
+#include "history.h"
 #include "home_html.h"
-#include "eepromutils.h"
+#include "settingsjournal.h"
 #include "network.h"
+#include "pagetemplate.h"
 #include "persistence.h"
+#include "settingsqueue.h"
+#include "statusformat.h"
 #include "utils.h"
 
 // enable debug printing in this module
@@ -22,24 +26,25 @@
 #define DEBUGDOPRINT(x)
 #define DEBUGDOPRINTLN(x)
 
-static const char page_head[] =
+static const char page_head[] PROGMEM =
         "<html>\n"
         "<head><title>ESP Thermostatic Controller</title></head>\n"
         "<body>\n";
-static const char page_tail[] = "</body></html>\n";
+static const char page_tail[] PROGMEM = "</body></html>\n";
 
-static char settings_form_page[] = \
+// %%EXTRA%% is the outcome of a POST; the other placeholders are persistent settings, by name.
+static const char settings_form_page[] PROGMEM = \
         "<form method='POST' action='/setup' >\n"
         "%%EXTRA%%"
         "<table>\n"
-        "<tr><td>WiFi SSID</td><td><input type=\"text\" name=\"ssid\" width=\"30\" value=\"%%SSID%%\"></td></tr>\n"
+        "<tr><td>WiFi SSID</td><td><input type=\"text\" name=\"ssid\" width=\"30\" value=\"%%ssid%%\"></td></tr>\n"
         //"<tr><td>WiFi password</td><td><input type=\"password\" name=\"pswd\" width=\"30\"></td></tr>\n"
         "<tr><td>WiFi password (visible)</td><td><input type=\"text\" name=\"pswd\" width=\"30\"></td></tr>\n"
-        "<tr><td>Unit identifier</td><td><input type=\"text\" name=\"ident\" width=\"30\" value=\"%%IDENT%%\"></td></tr>\n"
-        "<tr><td>Server hostname</td><td><input type=\"text\" name=\"host\" width=\"30\" value=\"%%HOST%%\"></td></tr>\n"
-        "<tr><td>Server port</td><td><input type=\"text\" name=\"port\" width=\"30\" value=\"%%PORT%%\"></td></tr>\n"
-        "<tr><td>Settings path</td><td><input type=\"text\" name=\"cpath\" width=\"30\" value=\"%%CFGPATH%%\"></td></tr>\n"
-        "<tr><td>Report path</td><td><input type=\"text\" name=\"rpath\" width=\"30\" value=\"%%RPTPATH%%\"></td></tr>\n"
+        "<tr><td>Unit identifier</td><td><input type=\"text\" name=\"ident\" width=\"30\" value=\"%%ident%%\"></td></tr>\n"
+        "<tr><td>Server hostname</td><td><input type=\"text\" name=\"host\" width=\"30\" value=\"%%rpthost%%\"></td></tr>\n"
+        "<tr><td>Server port</td><td><input type=\"text\" name=\"port\" width=\"30\" value=\"%%port%%\"></td></tr>\n"
+        "<tr><td>Settings path</td><td><input type=\"text\" name=\"cpath\" width=\"30\" value=\"%%cfgpath%%\"></td></tr>\n"
+        "<tr><td>Report path</td><td><input type=\"text\" name=\"rpath\" width=\"30\" value=\"%%rptpath%%\"></td></tr>\n"
         "</table>\n"
         "<input type=\"checkbox\" name=\"normalmode\" />Switch to normal mode\n"
         "<br><input type=\"submit\" value=\"Send\">\n"
@@ -48,160 +53,351 @@ static char settings_form_page[] = \
 
 static AsyncWebServer *server;
 
+/* The page is held both as text and gzip-compressed (see mkhtmlfile), both in flash, and sent from there. Every current browser accepts gzip,
+   and it's well under half the size, so less to push through the TCP stack over a weak WiFi link.
+   The two have different ETags, as a cache must not take one for the other.
+*/
 static void sendMainPage(AsyncWebServerRequest *request)
 {
     AsyncWebHeader  *ifnonematch_header;
-    DEBUGDOPRINTLN("Web request for sendMainPage");
-    if ( (ifnonematch_header = request->getHeader("if-none-match")) && ifnonematch_header->value() == String(home_etag))
+    AsyncWebHeader  *acceptencoding_header = request->getHeader("accept-encoding");
+    uint8_t         gzipped = acceptencoding_header && acceptencoding_header->value().indexOf("gzip") >= 0;
+    const char      *etag = gzipped ? home_gz_etag : home_etag;
+    AsyncWebServerResponse *response;
+    DEBUGDOPRINTLN(F("Web request for sendMainPage"));
+    if ( (ifnonematch_header = request->getHeader("if-none-match")) && ifnonematch_header->value() == etag)
     {
         // unchanged, so don't need to send content
-        DEBUGDOPRINTLN("Unchanged. Send 304");
-        request->send(304);
+        DEBUGDOPRINTLN(F("Unchanged. Send 304"));
+        response = request->beginResponse(304);
+    }
+    else if (gzipped)
+    {
+        response = request->beginResponse_P(200, "text/html", home_gz, home_gz_len);
+        response->addHeader("Content-Encoding", "gzip");
     }
     else
     {
-        AsyncWebServerResponse * response = request->beginResponse(200, "text/html", home_html);
-        response->addHeader("Etag", home_etag);
-        request->send(response);
+        response = request->beginResponse_P(200, "text/html", home_html);
     }
+    response->addHeader("Etag", etag);
+    response->addHeader("Vary", "Accept-Encoding");
+    request->send(response);
 }
 
-static void sendStatus(AsyncWebServerRequest *request)
+/* The status document is rendered once per tick of the control loop (publishStatus(), called from loop()),
+   not for every request, so any number of browsers polling /status cost little more than one.
+   Every client gets the same cached bytes, with an ETag made from a version number that only changes
+   when the content does, so a poll of an unchanged status gets a 304.
+   The ETag includes a random number chosen at boot, so a version from before a restart can't match.
+   There are two slots, used alternately: loop() renders into the one that isn't current, then makes it
+   current. Handlers, which run in the async TCP context, only read.
+   A slot is never rewritten while a response is still being sent from it: a handler counts itself in
+   (in_flight) before it uses a slot and out when the request is finished with, and loop() leaves a busy
+   slot alone, publishing on a later tick instead. Each side marks what it's doing before looking at the
+   other (seq is odd while a slot is being written), so they can't both go ahead. Neither ever waits.
+   The values are gathered into a STATUS_DATA snapshot first; if that is the same as last time, nothing
+   is rendered at all. Rendering (statusformat.cpp) writes straight into the buffers, without String.
+   /status.json is the same data as JSON, with the same version.
+   Browsers that keep /events open (Server-Sent Events) are pushed the full JSON when they connect and
+   then, on each change, a "delta" event holding just the fields that changed, with the version as its id.
+   If nothing has changed for STATUS_HEARTBEAT_MS, an "hb" event carrying the current version is sent, so
+   the page can tell that the connection is still alive and that it hasn't missed a delta.
+*/
+#define STATUS_BUF_SIZE     1024
+#define STATUS_HEARTBEAT_MS 15000
+#define STATUS_RECONNECT_MS 3000    // how long browsers wait before reconnecting to /events
+
+static_assert(MAX_TEMPERATURE_SENSORS <= STATUS_MAX_SENSORS, "STATUS_DATA has too few sensor slots");
+
+typedef struct {
+    volatile uint32_t   seq;        // odd while loop() is writing the slot
+    volatile uint8_t    in_flight;  // responses being sent from it
+    uint32_t    version;
+    size_t      xml_len;
+    size_t      json_len;
+    char        etag[24];
+    char        json_etag[24];
+    char        xml[STATUS_BUF_SIZE];
+    char        json[STATUS_BUF_SIZE];
+} STATUS_SLOT;
+
+static STATUS_SLOT      status_slots[2];
+static volatile uint8_t status_current = 0;
+static STATUS_DATA status_data;     // what the current slot was rendered from. loop() only
+static uint32_t status_version = 0; // loop() only
+static uint32_t status_boot_id;
+static AsyncEventSource *events;
+static uint32_t millis_at_last_event;
+
+static void gatherStatus(STATUS_DATA *status)
 {
     int sensor_index;
-    char addr_buf[17];
-    DEBUGDOPRINTLN("Web request for sendStatus");
-    String response = String("<status>\n");
+    memset(status, 0, sizeof *status);     // including padding, so the snapshots can be compared with memcmp
+    status->nb_sensors = sensor_data.nb_temperature_sensors;
     for (sensor_index = 0; sensor_index < sensor_data.nb_temperature_sensors; ++ sensor_index)
     {
-        response += String(" <tmp id=\"") +
-            String(formatAddr(addr_buf, sensor_data.temperature[sensor_index].addr)) +
-            String("\">") +
-            String(sensor_data.temperature[sensor_index].temperature_c) +
-            String("</tmp>\n");
+        memcpy(status->sensor_addr[sensor_index], sensor_data.temperature[sensor_index].addr, 8);
+        status->sensor_temperature[sensor_index] = sensor_data.temperature[sensor_index].temperature_c;
     }
-    response += String(" <state>") + String(power_state) + String("</state>\n") +
-                String(" <main>") + String(main_state) + String("</main>\n") +
-            String(" <des>")   + String(persistent_data.desired_temperature) + String("</des>\n") +
-            String(" <prec>")   + String(persistent_data.precision) + String("</prec>\n") +
-            String(" <switchoffsetabove>")   + String(switch_offset_above) + String("</switchoffsetabove>\n") +
-            String(" <switchoffsetbelow>")   + String(switch_offset_below) + String("</switchoffsetbelow>\n") +
-            String(" <mode>")   + String(persistent_data.mode == HEATING ? "heating" : "cooling") + String("</mode>\n") +
-            String(" <runon>") + String(persistent_data.fan_overrun_sec) + String("</runon>\n") +
-            String(" <maxrep>")   + String(persistent_data.max_time_between_reports) + String("</maxrep>\n") +
-        String("</status>\n");
-    DEBUGDOPRINTLN(response);
-    request->send(200, "text/xml", response);
+    status->power_state = power_state;
+    status->main_state = main_state;
+    status->heating = persistent_data.mode == HEATING;
+    status->desired_temperature = persistent_data.desired_temperature;
+    status->precision = persistent_data.precision;
+    status->switch_offset_above = switch_offset_above;
+    status->switch_offset_below = switch_offset_below;
+    status->fan_overrun_sec = persistent_data.fan_overrun_sec;
+    status->max_time_between_reports = persistent_data.max_time_between_reports;
+    status->boot.setup = boot_times.setup;
+    status->boot.settings = boot_times.settings;
+    status->boot.reading = boot_times.reading;
+    status->boot.decision = boot_times.decision;
+    status->boot.wifi = boot_times.wifi;
+    status->boot.fast = persistent_data.fast_boot;
 }
 
-static int checkAndSetPersistentFloatValue(const char *name, const char *val_str, float *target)
+static void pushStatusEvent(const STATUS_DATA *new_status)
 {
-    if (!val_str || !*val_str)
+    char delta[STATUS_BUF_SIZE];
+    char *end = formatStatusDeltaJson(delta, delta + sizeof delta - 1, &status_data, new_status);
+    *end = 0;
+    events->send(delta, "delta", status_version + 1);
+    millis_at_last_event = millis();
+}
+
+static void pushHeartbeatEvent()
+{
+    char version_str[12];
+    *appendUint(version_str, version_str + sizeof version_str - 1, status_version) = 0;
+    events->send(version_str, "hb", status_version);
+    millis_at_last_event = millis();
+}
+
+// Only ever called from loop() (and once before the web server starts)
+void publishStatus()
+{
+    STATUS_DATA new_status;
+    uint8_t next = !status_current;
+    STATUS_SLOT *slot = &status_slots[next];
+    gatherStatus(&new_status);
+    if (status_version && !memcmp(&new_status, &status_data, sizeof status_data))
+    {
+        // unchanged
+        if (events && events->count() && millis() - millis_at_last_event >= STATUS_HEARTBEAT_MS)
+        {
+            pushHeartbeatEvent();
+        }
+        return;
+    }
+    ++slot->seq;
+    __sync_synchronize();
+    if (slot->in_flight)
+    {
+        ++slot->seq;
+        return;     // still being sent to someone. Try again next tick
+    }
+    if (!status_version)
+    {
+        status_boot_id = ESP.random();
+    }
+    else if (events && events->count())
     {
-        // empty, don't set anything
-        return 0;
+        pushStatusEvent(&new_status);
     }
-    float new_temp = String(val_str).toFloat();
-    if (new_temp != *target)
+    status_data = new_status;
+    slot->xml_len = formatStatusXml(slot->xml, slot->xml + STATUS_BUF_SIZE, &status_data) - slot->xml;
+    slot->json_len = formatStatusJson(slot->json, slot->json + STATUS_BUF_SIZE, &status_data) - slot->json;
+    slot->version = ++status_version;
+    snprintf(slot->etag, sizeof slot->etag, "\"%08x-%u\"", status_boot_id, status_version);
+    snprintf(slot->json_etag, sizeof slot->json_etag, "\"%08x-%uj\"", status_boot_id, status_version);
+    __sync_synchronize();
+    ++slot->seq;
+    status_current = next;
+}
+
+// For handlers: the current slot, counted as in use until releaseStatusSlot(). NULL in the unlikely event
+// that loop() is switching slots at that very moment.
+static STATUS_SLOT *holdStatusSlot()
+{
+    uint8_t index = status_current;
+    STATUS_SLOT *slot = &status_slots[index];
+    ++slot->in_flight;
+    __sync_synchronize();
+    if (index == status_current && !(slot->seq & 1))
     {
-        DOPRINT  ("Setting ");
-        DOPRINT  (name);
-        DOPRINT  (" to ");
-        DOPRINTLN(new_temp);
-        *target = new_temp;
-        return 1;
+        return slot;
     }
+    --slot->in_flight;
     return 0;
 }
 
-static int checkAndSetPersistentUint8Value(const char *name, const char *val_str, uint8_t *target)
+static void releaseStatusSlot(STATUS_SLOT *slot)
 {
-    if (!val_str || !*val_str)
+    --slot->in_flight;
+}
+
+static void sendCachedStatus(AsyncWebServerRequest *request, uint8_t json)
+{
+    AsyncWebHeader  *ifnonematch_header;
+    AsyncWebServerResponse *response;
+    STATUS_SLOT *slot = holdStatusSlot();
+    const char *etag, *text;
+    size_t len;
+    if (!slot)
     {
-        // empty, don't set anything
-        return 0;
+        response = request->beginResponse(503);
+        response->addHeader("Retry-After", "1");
+        request->send(response);
+        return;
     }
-    uint8_t new_val = String(val_str).toInt();
-    if (new_val != *target)
+    etag = json ? slot->json_etag : slot->etag;
+    if ( (ifnonematch_header = request->getHeader("if-none-match")) && ifnonematch_header->value() == etag)
     {
-        DOPRINT  ("Setting ");
-        DOPRINT  (name);
-        DOPRINT  (" to ");
-        DOPRINTLN(new_val);
-        *target = new_val;
-        return 1;
+        releaseStatusSlot(slot);
+        request->send(304);
+        return;
     }
-    return 0;
+    text = json ? slot->json : slot->xml;
+    len = json ? slot->json_len : slot->xml_len;
+    // A filler, because the buffer overload of beginResponse() isn't in every version of the library
+    response = request->beginResponse(json ? "application/json" : "text/xml", len,
+                    [text, len](uint8_t *buf, size_t max_len, size_t index) -> size_t
+                    {
+                        size_t n = min(max_len, len - index);
+                        memcpy(buf, text + index, n);
+                        return n;
+                    });
+    response->addHeader("Etag", etag);
+    response->addHeader("Cache-Control", "no-cache");   // may keep it, but must check with us before using it
+    request->onDisconnect([slot]() { releaseStatusSlot(slot); });   // the response reads the slot as it goes
+    request->send(response);
+}
+
+static void sendStatus(AsyncWebServerRequest *request)
+{
+    DEBUGDOPRINTLN(F("Web request for sendStatus"));
+    sendCachedStatus(request, 0);
+}
+
+static void sendStatusJson(AsyncWebServerRequest *request)
+{
+    DEBUGDOPRINTLN(F("Web request for sendStatusJson"));
+    sendCachedStatus(request, 1);
+}
+
+/* The history tiers as a binary blob (format in history.h), produced piece by piece as the
+   web server asks for it rather than built whole. The view fixes the length, layout and the points
+   covered at the start. Samples added while it's being sent don't change those, though a very slow
+   client can find the oldest points blanked out (see HISTORY_VIEW).
+*/
+static void sendHistory(AsyncWebServerRequest *request)
+{
+    HISTORY_VIEW view;
+    AsyncWebServerResponse *response;
+    DEBUGDOPRINTLN(F("Web request for sendHistory"));
+    getHistoryView(&view);
+    response = request->beginResponse("application/octet-stream", historySize(&view),
+                    [view](uint8_t *buf, size_t max_len, size_t index) -> size_t
+                    {
+                        return readHistory(&view, buf, max_len, index);
+                    });
+    response->addHeader("Cache-Control", "no-store");
+    request->send(response);
 }
 
-static int checkAndSetPersistentUint32Value(const char *name, const char *val_str, uint32_t *target)
+// A browser has opened /events. Start it off with everything; deltas follow.
+static void eventsConnected(AsyncEventSourceClient *client)
 {
-    if (!val_str || !*val_str)
+    char json[STATUS_BUF_SIZE];
+    size_t len;
+    uint32_t version;
+    STATUS_SLOT *slot = holdStatusSlot();
+    DEBUGDOPRINTLN(F("Events client connected"));
+    if (!slot)
     {
-        // empty, don't set anything
-        return 0;
+        return;     // it'll get the next delta, and the heartbeat will tell it to fetch the rest
     }
-    uint32_t new_temp = String(val_str).toInt();
-    if (new_temp != *target)
+    len = slot->json_len;
+    memcpy(json, slot->json, len);
+    version = slot->version;
+    releaseStatusSlot(slot);
+    json[len ? len - 1 : 0] = 0;      // lose the newline
+    client->send(json, "status", version, STATUS_RECONNECT_MS);
+}
+
+/* Changes from the page's settings form. They're not applied here but queued for loop() (see settingsqueue.cpp),
+   so the reply is 202: the change shows up in /status and /events once loop() has made it, on its next tick.
+   The form's changes are queued all together or not at all. If there isn't room for all of them, the reply
+   is 503, and none of them has been made, so it can simply be tried again. A value too long ever to be
+   queued gets 400, again with nothing changed.
+   The fields are the ones marked SETTINGS_FORM in globals.h.
+*/
+
+// The setting a form field sets, with its name copied into item_name, or NULL if it sets nothing
+static PGM_P formSetting(AsyncWebParameter *p, char *item_name, size_t len)
+{
+    PGM_P item_name_P;
+    if (!p->value().length())
     {
-        DOPRINT  ("Setting ");
-        DOPRINT  (name);
-        DOPRINT  (" to ");
-        DOPRINTLN(new_temp);
-        *target = new_temp;
-        return 1;
+        return 0;   // empty, don't set anything
     }
-    return 0;
+    if ((item_name_P = findFormSetting(p->name().c_str(), SETTINGS_FORM)) != 0)
+    {
+        strncpy_P(item_name, item_name_P, len - 1);
+        item_name[len - 1] = 0;
+    }
+    return item_name_P;
 }
 
 static void settings(AsyncWebServerRequest *request)
 {
     int nb_params = request->params();
-    int made_a_change = 0;
-    DOPRINTLN("Web request for settings");
+    uint32_t size_needed = 0;
+    char item_name[32];
+    AsyncWebServerResponse *response;
+    DOPRINTLN(F("Web request for settings"));
     for (int i = 0; i < nb_params; i++)
     {
         AsyncWebParameter* p = request->getParam(i);
-        if (p->name() == "des_temp")
-        {
-            made_a_change |= checkAndSetPersistentFloatValue("des_temp", p->value().c_str(), &persistent_data.desired_temperature);
-        }
-        else if (p->name() == "precision")
-        {
-            made_a_change |= checkAndSetPersistentFloatValue("precision", p->value().c_str(), &persistent_data.precision);
-        }
-        else if (p->name() == "fan_overrun_sec")
-        {
-            made_a_change |= checkAndSetPersistentUint32Value("fan_overrun_sec", p->value().c_str(), &persistent_data.fan_overrun_sec);
-        }
-        else if (p->name() == "maxreporttime")
+        uint16_t size;
+        if (formSetting(p, item_name, sizeof item_name))
         {
-            made_a_change |= checkAndSetPersistentUint32Value("maxreporttime", p->value().c_str(), &persistent_data.max_time_between_reports);
+            if ( (size = settingSize(item_name, p->value().c_str())) == 0)
+            {
+                request->send(400, "text/plain", "Value too long: " + p->name() + "\n");
+                return;
+            }
+            size_needed += size;
         }
-        else if (p->name() == "mode")
+    }
+    if (size_needed > settingsQueueRoom())
+    {
+        response = request->beginResponse(503, "text/plain", "Busy, please try again\n");
+        response->addHeader("Retry-After", "1");
+        request->send(response);
+        return;
+    }
+    for (int i = 0; i < nb_params; i++)
+    {
+        AsyncWebParameter* p = request->getParam(i);
+        if (formSetting(p, item_name, sizeof item_name))
         {
-            made_a_change |= checkAndSetPersistentUint8Value("mode", p->value().c_str(), &persistent_data.mode);
+            queueSetting(item_name, p->value().c_str(), 0);     // there's room, checked above
         }
-    } 
-    if (made_a_change)
-    {
-        DOPRINTLN("Writing settings to EEPROM");
-        writeToEeprom();
     }
-    sendStatus(request);
+    request->send(202, "text/plain", "Accepted\n");
 }
 
-static int getNameIndex(const char *name)
+static PGM_P const setup_page_parts[] = {page_head, settings_form_page, page_tail, 0};
+
+static const char *setupPageValue(void *arg, const char *name, char *buf, size_t len)
 {
-    int i;
-    for (i = 0; name_mapping[i].html_field_name; ++i)
+    if (!strcmp(name, "EXTRA"))
     {
-        if (!strcmp(name, name_mapping[i].html_field_name))
-        {
-            return i;
-        }
+        return ((String*)arg)->c_str();
     }
-    return -1;
+    return getPersistentText(name, buf, len);
 }
 
 static void processSetupPath(AsyncWebServerRequest *request)
@@ -211,21 +407,21 @@ static void processSetupPath(AsyncWebServerRequest *request)
     uint8_t changed_something = 0;
     uint8_t switch_to_normal_mode = 0;
     String post_extra_response;
-    DOPRINTLN("Web request for processSetupPath");
+    DOPRINTLN(F("Web request for processSetupPath"));
     // We'll end up sending the form page, but for POST, it will have extra stuff in it to indicate
     // how the changes went.
     if (request->methodToString() == "POST")
     {
         int nb_params = request->params();
         DOPRINT(nb_params);
-        DOPRINTLN(" params");
+        DOPRINTLN(F(" params"));
         for (int i = 0; i < nb_params; i++)
         {
             AsyncWebParameter* p = request->getParam(i);
-            int item_index;
-            DOPRINT("arg: ");
+            PGM_P item_name_P;
+            DOPRINT(F("arg: "));
             DOPRINT(i);
-            DOPRINT(": ");
+            DOPRINT(F(": "));
             DOPRINTLN(p->name());
             p->name().toCharArray(name, 199);
             DOPRINTLN(name);
@@ -235,15 +431,17 @@ static void processSetupPath(AsyncWebServerRequest *request)
                 switch_to_normal_mode = 1;
                 continue;
             }
-            if ( (item_index = getNameIndex(name)) >= 0)
+            if ( (item_name_P = findFormSetting(name, SETUP_FORM)) != 0)
             {
                 // found it
-                char *item_name = name_mapping[item_index].persistent_item_name;
+                char item_name[32];
                 String value;
-                DOPRINT("found at index ");
-                DOPRINTLN(item_index);
+                strncpy_P(item_name, item_name_P, sizeof item_name - 1);
+                item_name[sizeof item_name - 1] = 0;
+                DOPRINT(F("found "));
+                DOPRINTLN(item_name);
                 value = p->value();
-                DOPRINTLN("got value");
+                DOPRINTLN(F("got value"));
                 DOPRINTLN(value);
                 if (!strncmp(item_name, "rot", 3))
                 {
@@ -270,29 +468,28 @@ static void processSetupPath(AsyncWebServerRequest *request)
             }
             else
             {
-                DOPRINTLN("not found");
+                DOPRINTLN(F("not found"));
             }
         }
         if (changed_something)
         {
             // Now check settings. Return appropriate page
-            // If OK, write to EEPROM, and then enter normal running.
+            // If OK, save, and then enter normal running.
             uint8_t res;
-            DOPRINTLN("Writing settings to EEPROM");
-            writeToEeprom();
-            post_extra_response += "<p><b>Settings saved to EEPROM.</b>\n";
-            DOPRINTLN("Check connection to WiFi");
+            requestSaveNow();   // by loop(), not here
+            post_extra_response += "<p><b>Settings saved.</b>\n";
+            DOPRINTLN(F("Check connection to WiFi"));
             if ( (res = connectWiFi()) != 0)
             {
                 // failed
-                DOPRINTLN("Failed to connect to WiFi");
+                DOPRINTLN(F("Failed to connect to WiFi"));
                 post_extra_response += "<p><b>Failed to connect to WiFi '";
                 post_extra_response += "'</b>\n<br>Please check settings</p>\n";
             }
             else if ( (res = connectTCP()) != 0)
             {
                 // failed
-                DOPRINTLN("Failed to connect to web server");
+                DOPRINTLN(F("Failed to connect to web server"));
                 post_extra_response += "<p><b>Failed to connect to web server '";
                 post_extra_response += "'</b>\n<br>Please check settings</p>\n";
             }
@@ -307,23 +504,27 @@ static void processSetupPath(AsyncWebServerRequest *request)
             }
         }
     }
-    String page = settings_form_page;
-    page.replace("%%EXTRA%%", post_extra_response);
-    page.replace("%%SSID%%", String(p_ssid ? p_ssid : ""));
-    page.replace("%%IDENT%%", String(p_report_hostname ? p_identifier : ""));
-    page.replace("%%HOST%%", String(p_report_hostname ? p_report_hostname : ""));
-    page.replace("%%PORT%%", String(persistent_data.port));
-    page.replace("%%CFGPATH%%", String(p_cfg_path ? p_cfg_path : ""));
-    page.replace("%%RPTPATH%%", String(p_report_path ? p_report_path : ""));
-    request->send(200, "text/html", page_head + page + page_tail);
+    // Streamed from flash a chunk at a time. The lambda keeps its own copy of the extra text until the
+    // response is done with it.
+    request->send(request->beginChunkedResponse("text/html",
+                    [post_extra_response](uint8_t *buf, size_t max_len, size_t index) mutable -> size_t
+                    {
+                        return renderTemplate(setup_page_parts, setupPageValue, &post_extra_response, buf, max_len, index);
+                    }));
 }
 
 void startAsyncWebServer()
 {
     server = new AsyncWebServer(80);
+    publishStatus();    // so there's something to serve before loop() first runs
     server->on("/",             HTTP_GET,   [](AsyncWebServerRequest *request) { sendMainPage(request); });
     server->on("/status",       HTTP_GET,   [](AsyncWebServerRequest *request) { sendStatus(request); });
+    server->on("/status.json",  HTTP_GET,   [](AsyncWebServerRequest *request) { sendStatusJson(request); });
+    server->on("/history",      HTTP_GET,   [](AsyncWebServerRequest *request) { sendHistory(request); });
     server->on("/settings",     HTTP_GET,   [](AsyncWebServerRequest *request) { settings(request); });
     server->on("/setup",        HTTP_GET | HTTP_POST,   [](AsyncWebServerRequest *request) { processSetupPath(request); });
+    events = new AsyncEventSource("/events");
+    events->onConnect(eventsConnected);
+    server->addHandler(events);
     server->begin();
 }
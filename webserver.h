@@ -3,3 +3,4 @@
   jeff at jamcupboard.co.uk
 */
 void startAsyncWebServer();
+void publishStatus();